@@ -0,0 +1,20 @@
+QT += core widgets
+QT += multimedia
+
+TARGET = 277
+TEMPLATE = app
+CONFIG += c++11
+CONFIG += warn_on
+CONFIG += debug
+
+# Next to the top-level Makefile, where asan-run.sh looks for it
+DESTDIR = $$OUT_PWD/..
+
+INCLUDEPATH += $$PWD/../include
+
+include(../src/src.pri)
+
+FORMS += ../forms/mainwindow.ui \
+    ../forms/cameracontrolshelp.ui
+
+RESOURCES += ../glsl.qrc
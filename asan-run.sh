@@ -9,7 +9,7 @@ export ASAN_OPTIONS=detect_leaks=0
 export LIBGL_DEBUG=1
 export MESA_DEBUG=1
 
-while getopts "soi" OPTION ; do
+while getopts "soib:" OPTION ; do
     case $OPTION in
         s)
             # Use software rendering (needed if running without a screen).
@@ -30,7 +30,18 @@ while getopts "soi" OPTION ; do
             # an image and then exit. For automated testing.
             export CIS277_AUTOTESTING=1
             ;;
+        b)
+            # Fly the camera along a fixed path through a seeded world, record
+            # OPTARG frames into benchmark.json and exit. Combine with -s -o to
+            # measure software rendering on machines without a GPU.
+            export CIS277_BENCHMARK=$OPTARG
+            ;;
     esac
 done
 
+# Without a display, the benchmark renders into a virtual X server
+if [ -n "$CIS277_BENCHMARK" ] && [ -z "$DISPLAY" ] && command -v xvfb-run > /dev/null ; then
+    exec xvfb-run -a build-asan/277
+fi
+
 exec build-asan/277
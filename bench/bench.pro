@@ -0,0 +1,35 @@
+QT += core widgets
+QT += multimedia
+
+TARGET = 277-bench
+TEMPLATE = app
+CONFIG += c++11
+CONFIG += warn_on
+CONFIG += console
+# Timings only mean something with optimizations on
+CONFIG -= debug
+CONFIG += release
+
+DESTDIR = $$OUT_PWD/..
+
+INCLUDEPATH += $$PWD/../include
+
+# Everything but the window: the engine sources are shared with the game
+include(../src/src.pri)
+SRC = $$clean_path($$PWD/../src)
+SOURCES -= \
+    $$SRC/main.cpp \
+    $$SRC/mainwindow.cpp \
+    $$SRC/mygl.cpp \
+    $$SRC/cameracontrolshelp.cpp
+HEADERS -= \
+    $$SRC/mainwindow.h \
+    $$SRC/mygl.h \
+    $$SRC/cameracontrolshelp.h
+
+SOURCES += \
+    $$PWD/main.cpp \
+    $$PWD/microbench.cpp
+
+HEADERS += \
+    $$PWD/microbench.h
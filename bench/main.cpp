@@ -0,0 +1,283 @@
+#include "microbench.h"
+#include <scene/scene.h>
+#include <scene/raybatch.h>
+#include <generators/lparser.h>
+#include <openGL/glwidget277.h>
+#include <openGL/chunkmesh.h>
+#include <scene/meshdata.h>
+#include <benchmark.h>
+#include <jobs.h>
+
+#include <QApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <QDebug>
+#include <stdlib.h>
+#include <math.h>
+
+// Microbenchmarks of the engine's kernels, in nanoseconds per operation. The world is generated
+// from Benchmark::DEFAULT_SEED, so runs are comparable. Pass part of a kernel name to run only
+// the matching kernels. Results also go to microbench.json, or $CIS277_MICROBENCH_OUT.
+
+static const int LOOKUPS = 4096;    // points per lookup kernel call
+static const int RAYS = 1024;       // rays per ray kernel call
+static const int CONE_RAYS = 1 << 16;   // rays per batch cast in a cone, enough to spread over jobs
+static const int SAMPLES = 64;      // terrain samples along each side of the grid
+
+static float random01()
+{
+    return ((float) rand()) / (float) RAND_MAX;
+}
+
+// Points in the 5 x 5 chunks at the origin, the middle of the generated window, up to
+// MAX_TERRAIN_HEIGHT chunks tall
+static QVector<Point3> randomPoints(int count)
+{
+    QVector<Point3> points;
+    for (int i = 0; i < count; i++) {
+        points.append(Point3(glm::floor(random01() * 80), glm::floor(random01() * Scene::MAX_TERRAIN_HEIGHT * 16),
+                             glm::floor(random01() * 80)));
+    }
+    return points;
+}
+
+// Rays from above the middle of the world, looking down at the terrain
+static QVector<Ray> randomRays(int count)
+{
+    QVector<Ray> rays;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 dir = glm::normalize(glm::vec3(random01() * 2 - 1, -0.5f - random01(), random01() * 2 - 1));
+        rays.append(Ray(glm::vec3(40, 40, 40), dir));
+    }
+    return rays;
+}
+
+// Rays in a cone around one ray, like a batch cast around the crosshair
+static QVector<Ray> coneRays(const Ray &center, int count)
+{
+    glm::vec3 up = fabs(center.direction.y) < 0.99f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+    glm::vec3 right = glm::normalize(glm::cross(center.direction, up));
+    up = glm::cross(right, center.direction);
+    QVector<Ray> rays;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 dir = glm::normalize(center.direction + (random01() * 2 - 1) * right + (random01() * 2 - 1) * up);
+        rays.append(Ray(center.origin, dir));
+    }
+    return rays;
+}
+
+// The picking MyGL::raymarchCast does, stepping 0.1 blocks at a time from the camera, without
+// the widget around it
+static Point3 raymarchPick(Scene &scene, const Ray &ray)
+{
+    for (float t = 0.1; t < 32.f; t += 0.1) {
+        glm::vec3 position = ray.origin + t * ray.direction;
+        Point3 cube(glm::floor(position.x), glm::floor(position.y), glm::floor(position.z));
+        if (scene.isFilled(cube)) {
+            return cube;
+        }
+    }
+    return Point3(INFINITY, INFINITY, INFINITY);
+}
+
+// Chunks whose meshes are timed: real terrain, the worst case for face count, and one with
+// nothing inside to mesh
+static CellGrid checkerboardCells()
+{
+    ChunkData chunk(0);
+    for (int x = 0; x < 16; x++) {
+        for (int y = 0; y < 16; y++) {
+            for (int z = 0; z < 16; z++) {
+                chunk.cells[x][y][z] = (x + y + z) % 2 ? STONE : EMPTY;
+            }
+        }
+    }
+    return chunk.cells;
+}
+
+static CellGrid solidCells()
+{
+    ChunkData chunk(0);
+    for (int x = 0; x < 16; x++) {
+        for (int y = 0; y < 16; y++) {
+            for (int z = 0; z < 16; z++) {
+                chunk.cells[x][y][z] = STONE;
+            }
+        }
+    }
+    return chunk.cells;
+}
+
+static void benchMeshing(MicroBench &bench, const QString &name, const CellGrid &cells)
+{
+    ChunkData chunk(cells);
+    bench.run("chunk update " + name, 1, [&]() {
+        chunk.update();
+    });
+    bench.run("chunk mesh " + name, 1, [&]() {
+        MeshData mesh;
+        MeshData::buildVertices(chunk.cells, mesh);
+        MicroBench::consume(mesh.vertices.size());
+    });
+    bench.run("chunk faces " + name, 1, [&]() {
+        MeshData mesh;
+        MeshData::buildFaces(chunk.cells, mesh);
+        MicroBench::consume(mesh.faces.size());
+    });
+}
+
+// Copying meshes into the ChunkArena needs a GL context; it is made current on an offscreen
+// surface, so no window is opened. GLWidget277 only supplies the GL functions here
+static void benchUpload(MicroBench &bench, const CellGrid &cells)
+{
+    QOffscreenSurface surface;
+    surface.setFormat(QSurfaceFormat::defaultFormat());
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(QSurfaceFormat::defaultFormat());
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        bench.skip("chunk upload", "no OpenGL 3.2 context");
+        return;
+    }
+    GLWidget277 gl(nullptr);
+    if (!gl.initializeOpenGLFunctions()) {
+        bench.skip("chunk upload", "no OpenGL 3.2 core functions");
+        return;
+    }
+
+    ChunkArena arena;
+    arena.create(gl);
+    {
+        // Destroyed before the arena, which its slots belong to. Every update marks the cells
+        // changed, so each run meshes the chunk in a job and uploads the result, as a frame does
+        ChunkData chunk(cells);
+        QVector<ChunkMesh*> meshes;
+        meshes.append(ChunkMesh::of(chunk));
+        bench.run("chunk mesh+upload surface", 1, [&]() {
+            ChunkMesh::remesh(meshes);
+            do {
+                ChunkMesh::collect(gl, arena);
+            } while (meshes[0]->building());
+            gl.glFinish();
+        }, [&]() {
+            chunk.update();
+        });
+    }
+    arena.destroy(gl);
+    context.doneCurrent();
+}
+
+int main(int argc, char *argv[])
+{
+    // Without a display, Qt renders through its offscreen platform
+    if (qgetenv("DISPLAY").isEmpty() && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication a(argc, argv);
+
+    QSurfaceFormat format;
+    format.setVersion(3, 2);
+    format.setOption(QSurfaceFormat::DeprecatedFunctions, false);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    JobSystem::start();
+    Terrain::seed = Benchmark::DEFAULT_SEED;
+    srand(Benchmark::DEFAULT_SEED);
+    Scene scene;
+    scene.CreateNewChunks();
+
+    MicroBench bench(argc > 1 ? QString(argv[1]) : QString());
+
+    // Meshing
+    ChunkData *surface = scene.getContainingChunk(Point3(40, 0, 40));
+    benchMeshing(bench, "surface", surface->cells);
+    benchMeshing(bench, "checkerboard", checkerboardCells());
+    benchMeshing(bench, "solid", solidCells());
+    benchUpload(bench, surface->cells);
+
+    // Terrain height, over a grid covering the generated world
+    bench.run("terrain getBlock", SAMPLES * SAMPLES, [&]() {
+        for (int i = 0; i < SAMPLES; i++) {
+            for (int j = 0; j < SAMPLES; j++) {
+                MicroBench::consume(scene.terrain.getBlock(i / (float) SAMPLES, j / (float) SAMPLES));
+            }
+        }
+    });
+    bench.run("terrain sample", SAMPLES * SAMPLES, [&]() {
+        for (int i = 0; i < SAMPLES; i++) {
+            for (int j = 0; j < SAMPLES; j++) {
+                MicroBench::consume(scene.terrain.sample(i / (float) SAMPLES, j / (float) SAMPLES));
+            }
+        }
+    });
+
+    // Lookups
+    QVector<Point3> points = randomPoints(LOOKUPS);
+    bench.run("scene getContainingNode", LOOKUPS, [&]() {
+        for (const Point3 &p : points) {
+            MicroBench::consume(scene.getContainingNode(p)->length);
+        }
+    });
+    bench.run("scene isFilled", LOOKUPS, [&]() {
+        for (const Point3 &p : points) {
+            MicroBench::consume(scene.isFilled(p));
+        }
+    });
+
+    // Ray casts
+    QVector<Ray> rays = randomRays(RAYS);
+    bench.run("octree rayCastOct", RAYS, [&]() {
+        for (const Ray &ray : rays) {
+            MicroBench::consume(scene.octree->rayCastOct(ray) != nullptr);
+        }
+    });
+    bench.run("raymarch pick", RAYS, [&]() {
+        for (const Ray &ray : rays) {
+            MicroBench::consume(raymarchPick(scene, ray).y);
+        }
+    });
+    bench.run("raybatch cast", RAYS, [&]() {
+        MicroBench::consume(RayBatch::cast(scene, rays).size());
+    });
+    QVector<Ray> cone = coneRays(Ray(glm::vec3(40, 40, 40), glm::normalize(glm::vec3(1, -1, 1))), CONE_RAYS);
+    bench.run("raybatch cast cone", CONE_RAYS, [&]() {
+        MicroBench::consume(RayBatch::cast(scene, cone).size());
+    });
+
+    // L-systems, with the grammar of LParser::makeTree
+    QVector<QString> a_rules, f_rules, s_rules, l_rules;
+    a_rules.push_back("[&FL!A]/////`[&FL!A]///////`[&FL!A]");
+    f_rules.push_back("S ///// F");
+    s_rules.push_back("F L");
+    l_rules.push_back("[```^^{-f+f+f-|-f+f+f}]");
+    QMap<QChar, QVector<QString> > productions {{'A', a_rules}, {'F', f_rules}, {'S', s_rules}, {'L', l_rules}};
+    QString axiom = "A";
+    QString pattern = LParser::expand(productions, 7, axiom);
+    bench.run("lparser expand tree", 1, [&]() {
+        QString start = "A";
+        MicroBench::consume(LParser::expand(productions, 7, start).size());
+    });
+    bench.run("lparser createDrawables tree", 1, [&]() {
+        MicroBench::consume(LParser::createDrawables(pattern).size());
+    });
+
+    // Edits; the same tree is planted over and over, remeshing the chunks it touches
+    QVector<LPair_t> tree = LParser::makeTree();
+    bench.run("scene voxelize tree", 1, [&]() {
+        scene.voxelize(tree, Point3(40, 16, 40));
+    });
+
+    QString output = qgetenv("CIS277_MICROBENCH_OUT");
+    if (output.isEmpty()) {
+        output = "microbench.json";
+    }
+    bool written = bench.write(output);
+    JobSystem::stop();
+    if (!written) {
+        qWarning() << "Couldn't write" << output;
+        return 1;
+    }
+    return 0;
+}
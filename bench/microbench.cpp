@@ -0,0 +1,101 @@
+#include "microbench.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstdio>
+
+const int MicroBench::WARMUP_MS;
+const int MicroBench::REPETITION_MS;
+const int MicroBench::REPETITIONS;
+
+volatile long long MicroBench::sink = 0;
+
+MicroBench::MicroBench(const QString &filter) : filter(filter)
+{
+    printf("%-36s %12s %12s %12s\n", "kernel", "median ns/op", "min ns/op", "max ns/op");
+}
+
+void MicroBench::run(const QString &name, int ops, const std::function<void()> &kernel,
+                     const std::function<void()> &setup)
+{
+    if (!name.contains(filter)) {
+        return;
+    }
+
+    // Warm up, and see how many calls fill a repetition
+    QElapsedTimer timer;
+    qint64 timed_ns = 0;
+    int calls = 0;
+    timer.start();
+    while (calls == 0 || timer.elapsed() < WARMUP_MS) {
+        if (setup) {
+            setup();
+        }
+        QElapsedTimer call;
+        call.start();
+        kernel();
+        timed_ns += call.nsecsElapsed();
+        calls++;
+    }
+    int calls_per_repetition = std::max(1, (int) ((qint64) REPETITION_MS * 1000000 * calls / std::max(timed_ns, (qint64) 1)));
+
+    QVector<double> ns_per_op;
+    for (int r = 0; r < REPETITIONS; r++) {
+        qint64 elapsed = 0;
+        for (int c = 0; c < calls_per_repetition; c++) {
+            if (setup) {
+                setup();
+            }
+            timer.start();
+            kernel();
+            elapsed += timer.nsecsElapsed();
+        }
+        ns_per_op.push_back((double) elapsed / ((qint64) calls_per_repetition * ops));
+    }
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+
+    BenchResult result = {name, ns_per_op[REPETITIONS / 2], ns_per_op.first(), ns_per_op.last(),
+                          (qint64) REPETITIONS * calls_per_repetition * ops};
+    timings.push_back(result);
+    printf("%-36s %12.1f %12.1f %12.1f\n", qPrintable(name), result.median_ns, result.min_ns, result.max_ns);
+    fflush(stdout);
+}
+
+void MicroBench::skip(const QString &group, const QString &reason)
+{
+    printf("%-36s skipped: %s\n", qPrintable(group), qPrintable(reason));
+}
+
+const QVector<BenchResult>& MicroBench::results() const
+{
+    return timings;
+}
+
+bool MicroBench::write(const QString &path) const
+{
+    QJsonArray kernels;
+    for (const BenchResult &r : timings) {
+        QJsonObject kernel;
+        kernel["name"] = r.name;
+        kernel["median_ns"] = r.median_ns;
+        kernel["min_ns"] = r.min_ns;
+        kernel["max_ns"] = r.max_ns;
+        kernel["ops"] = (double) r.ops;
+        kernels.append(kernel);
+    }
+    QJsonObject report;
+    report["warmup_ms"] = WARMUP_MS;
+    report["repetition_ms"] = REPETITION_MS;
+    report["repetitions"] = REPETITIONS;
+    report["kernels"] = kernels;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(report).toJson());
+    return true;
+}
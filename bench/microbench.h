@@ -0,0 +1,55 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <functional>
+#include <QString>
+#include <QVector>
+
+// Timing of one kernel, in nanoseconds per operation
+struct BenchResult {
+    QString name;
+    double median_ns;
+    double min_ns;
+    double max_ns;
+    qint64 ops;     // operations timed, warmup excluded
+};
+
+// Runs kernels and reports how long one operation takes. Each kernel is called until
+// WARMUP_MS have passed, to fill caches and start the thread pool, then timed REPETITIONS
+// times. A repetition calls the kernel enough times to last at least REPETITION_MS, so short
+// kernels aren't lost in the clock's resolution; the median repetition is reported.
+class MicroBench
+{
+public:
+    static const int WARMUP_MS = 100;
+    static const int REPETITION_MS = 50;
+    static const int REPETITIONS = 11;
+
+    // Only kernels whose name contains filter run
+    explicit MicroBench(const QString &filter = QString());
+
+    // kernel performs ops operations per call. setup, if given, runs untimed before every call
+    void run(const QString &name, int ops, const std::function<void()> &kernel,
+             const std::function<void()> &setup = std::function<void()>());
+    // Prints a line explaining why a group of kernels didn't run
+    void skip(const QString &group, const QString &reason);
+
+    const QVector<BenchResult>& results() const;
+    // Writes the results as JSON; false if the file can't be written
+    bool write(const QString &path) const;
+
+    // Keeps the compiler from discarding a result the kernel doesn't otherwise use
+    template <typename T>
+    static void consume(const T &value)
+    {
+        sink = sink + (long long) value;
+    }
+
+private:
+    QString filter;
+    QVector<BenchResult> timings;
+
+    static volatile long long sink;
+};
+
+#endif // MICROBENCH_H
@@ -1,24 +1,7 @@
-QT += core widgets
-QT += multimedia
-
-TARGET = 277
-TEMPLATE = app
-CONFIG += c++11
-CONFIG += warn_on
-CONFIG += debug
-
-INCLUDEPATH += include
-
-include(src/src.pri)
-
-FORMS += forms/mainwindow.ui \
-    forms/cameracontrolshelp.ui \
-    forms/hud.ui
-
-RESOURCES += glsl.qrc
-
-HEADERS += \
-    forms/hud.h \
-
-SOURCES += \
-    forms/hud.cpp \
+# The GL-free world library, and the game, the microbenchmarks and the headless world
+# generator built on it
+TEMPLATE = subdirs
+SUBDIRS = world app bench worldgen
+app.depends = world
+bench.depends = world
+worldgen.depends = world
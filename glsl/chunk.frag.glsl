@@ -0,0 +1,45 @@
+#version 150
+// ^ Change this to version 130 if you have compatibility issues
+
+// Fragment shader for chunk meshes. Same lighting as lambert.frag.glsl, but textures come from
+// the block tile array: fs_uv is the position within the tile and fs_Layer the tile's layer.
+
+in vec3 fs_Nor;
+in vec3 fs_LightVec;
+in vec3 fs_Col;
+in vec2 fs_uv;
+flat in int fs_Layer;
+flat in int fs_Flags;   // BlockFlag bits: 1 = animated, 2 = emissive, 4 = translucent, 8 = opaque
+
+uniform sampler2DArray u_Tiles;
+
+out vec4 out_Col;
+
+void main()
+{
+    vec3 diffuseColor;
+    if ((fs_Flags & 1) != 0) {
+        // Animated tiles scroll into the tile to their right in the atlas, which is the next
+        // layer. Gradients come from the unwrapped coordinates so the seam keeps its mip level
+        float tile = floor(fs_uv.x);
+        vec3 coord = vec3(fs_uv.x - tile, fs_uv.y, fs_Layer + tile);
+        diffuseColor = textureGrad(u_Tiles, coord, dFdx(fs_uv), dFdy(fs_uv)).rgb;
+    } else {
+        diffuseColor = texture(u_Tiles, vec3(fs_uv, fs_Layer)).rgb;
+    }
+
+    // Calculate the diffuse term for Lambert shading
+    float diffuseTerm = dot(normalize(fs_Nor), normalize(fs_LightVec));
+    // Avoid negative lighting values
+    diffuseTerm = clamp(diffuseTerm, 0, 1);
+
+    // Alpha only matters in the blended pass
+    float alpha = (fs_Flags & 4) != 0 ? 0.6 : 1.0;
+
+    if ((fs_Flags & 2) == 0) {
+        out_Col = vec4(diffuseColor, alpha);
+    }
+    else {
+        out_Col = vec4(diffuseColor * 2.0, alpha);
+    }
+}
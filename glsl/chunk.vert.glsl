@@ -0,0 +1,52 @@
+#version 150
+// ^ Change this to version 130 if you have compatibility issues
+
+// Vertex shader for chunk meshes stored in the ChunkArena. Positions are relative to their
+// chunk, so instead of a model matrix per draw each vertex carries the slot of its chunk and
+// looks the chunk's origin up in u_ChunkOrigins. This lets every visible chunk be drawn in
+// a single call. Shading is done by chunk.frag.glsl.
+
+uniform mat4 u_ViewProj;    // The matrix that defines the camera's transformation.
+
+uniform samplerBuffer u_ChunkOrigins;   // One texel per arena slot: xyz = chunk origin, w = scale
+
+uniform float u_Time;   // Seconds since the widget started, drives texture animation
+
+in vec3 vs_Pos;     // Position relative to the chunk's origin
+in vec3 vs_Nor;
+in uvec4 vs_Tile;   // u and v corner of the tile, tile array layer, BlockFlag bits (animated, emissive, translucent, opaque)
+in float vs_Slot;   // Row of u_ChunkOrigins holding this vertex's chunk
+
+out vec3 fs_Nor;
+out vec3 fs_LightVec;
+out vec3 fs_Col;
+out vec2 fs_uv;     // in tiles
+flat out int fs_Layer;
+flat out int fs_Flags;
+
+const vec4 lightDir = vec4(1,1,1,0);  // The position of our virtual light, which is used to compute the shading of
+                                        // the geometry in the fragment shader.
+
+const float ANIMATION_RATE = 12.0;
+
+void main()
+{
+    fs_Col = vec3(1);
+    // Chunks are only ever translated, so normals need no transformation
+    fs_Nor = vs_Nor;
+
+    fs_uv = vec2(vs_Tile.xy);
+    fs_Layer = int(vs_Tile.z);
+    fs_Flags = int(vs_Tile.w);
+    // Animated tiles scroll one tile across ANIMATION_RATE times a second
+    if ((fs_Flags & 1) != 0) {
+        fs_uv.x += fract(u_Time * ANIMATION_RATE);
+    }
+
+    vec4 origin = texelFetch(u_ChunkOrigins, int(vs_Slot));
+    vec4 modelposition = vec4(vs_Pos * origin.w + origin.xyz, 1);
+
+    fs_LightVec = (lightDir).xyz;  //   Compute the direction in which the light source lies
+
+    gl_Position = u_ViewProj * modelposition;
+}
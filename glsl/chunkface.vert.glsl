@@ -0,0 +1,79 @@
+#version 150
+// ^ Change this to version 130 if you have compatibility issues
+
+// Vertex shader for chunk meshes stored as packed faces in the ChunkArena. Nothing is read
+// from vertex attributes: each face is drawn as six vertices, and gl_VertexID picks both the
+// face record in u_ChunkFaces and the corner of the face to emit. A record holds the cell's
+// position within its chunk, the direction the face points, its block and its arena slot
+// (see packFace in meshdata.h). Shading is done by chunk.frag.glsl.
+
+uniform mat4 u_ViewProj;    // The matrix that defines the camera's transformation.
+
+uniform samplerBuffer u_ChunkOrigins;   // One texel per arena slot: xyz = chunk origin, w = scale
+uniform usamplerBuffer u_ChunkFaces;    // One packed face record per texel
+
+uniform float u_Time;   // Seconds since the widget started, drives texture animation
+
+// The block registry (BLOCKS in blocks.h), uploaded by ShaderProgram::create
+uniform int u_BlockTiles[96];   // tile array layer of face f of block b at b * 6 + f
+uniform int u_BlockFlags[16];   // BlockFlag bits of each block, as many as a face record holds
+
+out vec3 fs_Nor;
+out vec3 fs_LightVec;
+out vec3 fs_Col;
+out vec2 fs_uv;     // in tiles
+flat out int fs_Layer;
+flat out int fs_Flags;
+
+const vec4 lightDir = vec4(1,1,1,0);  // The position of our virtual light, which is used to compute the shading of
+                                        // the geometry in the fragment shader.
+
+const float ANIMATION_RATE = 12.0;
+
+// The two triangles of a face, as corners of the quad
+const int quadCorners[6] = int[](0, 1, 2, 0, 2, 3);
+
+// Corners of each face relative to its cell, in ChunkFace order: +x, -x, +y, -y, +z, -z
+const vec3 faceCorners[24] = vec3[](
+    vec3(1,1,0), vec3(1,0,0), vec3(1,0,1), vec3(1,1,1),
+    vec3(0,1,1), vec3(0,0,1), vec3(0,0,0), vec3(0,1,0),
+    vec3(1,1,0), vec3(1,1,1), vec3(0,1,1), vec3(0,1,0),
+    vec3(1,0,1), vec3(1,0,0), vec3(0,0,0), vec3(0,0,1),
+    vec3(1,1,1), vec3(1,0,1), vec3(0,0,1), vec3(0,1,1),
+    vec3(0,1,0), vec3(0,0,0), vec3(1,0,0), vec3(1,1,0));
+
+const vec3 faceNormals[6] = vec3[](
+    vec3(1,0,0), vec3(-1,0,0), vec3(0,1,0), vec3(0,-1,0), vec3(0,0,1), vec3(0,0,-1));
+
+// Corner of the tile each quad corner maps to, matching the order of faceCorners
+const vec2 tileCorners[4] = vec2[](vec2(1,0), vec2(1,1), vec2(0,1), vec2(0,0));
+
+void main()
+{
+    uint face = texelFetch(u_ChunkFaces, gl_VertexID / 6).r;
+    int corner = quadCorners[gl_VertexID % 6];
+
+    vec3 cell = vec3(float(face & 15u), float((face >> 4) & 15u), float((face >> 8) & 15u));
+    int dir = int((face >> 12) & 7u);
+    int block = int((face >> 15) & 15u);
+    int slot = int(face >> 19);
+
+    fs_Col = vec3(1);
+    // Chunks are only ever translated, so normals need no transformation
+    fs_Nor = faceNormals[dir];
+
+    fs_Layer = u_BlockTiles[block * 6 + dir];
+    fs_Flags = u_BlockFlags[block];
+    fs_uv = tileCorners[corner];
+    // Animated tiles scroll one tile across ANIMATION_RATE times a second
+    if ((fs_Flags & 1) != 0) {
+        fs_uv.x += fract(u_Time * ANIMATION_RATE);
+    }
+
+    vec4 origin = texelFetch(u_ChunkOrigins, slot);
+    vec4 modelposition = vec4((cell + faceCorners[dir * 4 + corner]) * origin.w + origin.xyz, 1);
+
+    fs_LightVec = (lightDir).xyz;  //   Compute the direction in which the light source lies
+
+    gl_Position = u_ViewProj * modelposition;
+}
@@ -17,7 +17,7 @@ in vec4 fs_uv;
 uniform sampler2D myTexture;
 //rememmber to set sampler2d
 
-out vec3 out_Col;  // This is the final output color that you will see on your screen for the pixel that is currently being processed.
+out vec4 out_Col;  // This is the final output color that you will see on your screen for the pixel that is currently being processed.
 
 void main()
 {
@@ -38,12 +38,15 @@ void main()
                                                         // to simulate ambient lighting. This ensures that faces that are not
                                                         // lit by our point light are not completely black.
 
+    // Water (animated, not lava) is see-through; alpha only matters in the blended pass
+    float alpha = (fs_uv.z == 1 && fs_uv.w != 1) ? 0.6 : 1.0;
+
     // Compute final shaded color
     if (fs_uv.w != 1) {
-        out_Col = diffuseColor;// lightIntensity;
+        out_Col = vec4(diffuseColor, alpha);// lightIntensity;
     }
     else {
-        out_Col = diffuseColor * 2.0;
+        out_Col = vec4(diffuseColor * 2.0, alpha);
     }
     // out_Col = normalize(abs(fs_Nor));
 }
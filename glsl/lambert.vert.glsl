@@ -20,7 +20,7 @@ uniform mat4 u_ViewProj;    // The matrix that defines the camera's transformati
                             // We've written a static matrix for you to use for HW2,
                             // but in HW3 you'll have to generate one yourself
 
-uniform int timer;
+uniform float u_Time;   // Seconds since the widget started, drives texture animation
 
 in vec3 vs_Pos;  // ---------->The array of vertex positions passed to the shader
 
@@ -41,48 +41,18 @@ out vec4 fs_uv;
 const vec4 lightDir = vec4(1,1,1,0);  // The position of our virtual light, which is used to compute the shading of
                                         // the geometry in the fragment shader.
 
+const float ANIMATION_RATE = 12.0;
+
 void main()
 {
     fs_Col = vs_Col;  //                          Pass the vertex color positions to the fragment shader
     fs_Nor = vec3(u_ModelInvTr * vec4(vs_Nor, 0));  //           Transform the geometry's normals
 
-    //3rd value is 1 = animation;
+    //3rd value is 1 = animation; the texture scrolls one tile across ANIMATION_RATE times a second
+    fs_uv = vs_uv;
     if (vs_uv.b == 1) {
-        //no offset
-        if (timer == 0) {
-            fs_uv = vs_uv;
-        }
-        //offset = 1
-        else if (timer == 1) {
-            fs_uv = vec4(vs_uv.x + 0.3/16.f, vs_uv.y, vs_uv.z, vs_uv.w);
-            //fs_uv = vec4(1,0,0,0);
-        }
-
-        //offset = 2
-        else if (timer == 2) {
-            fs_uv = vec4(vs_uv.x + 0.6/16.f, vs_uv.y, vs_uv.z, vs_uv.w);
-            //fs_uv = vec4(0,1,0,0);
-        }
-
-        //offset = 3
-        else if (timer == 3) {
-            fs_uv = vec4(vs_uv.x + 0.9/16.f, vs_uv.y, vs_uv.z, vs_uv.w);
-            //fs_uv = vec4(0,0,1,0);
-        }
-
-        //offset = 4
-        else if (timer == 4) {
-            fs_uv = vec4(vs_uv.x + 1/16.f, vs_uv.y, vs_uv.z, vs_uv.w);
-            //fs_uv = vec4(1,1,1,0);
-        }
-    }
-
-    //no animation; out = in
-    else {
-        fs_uv = vs_uv; // out uv = in uv
-        //fs_uv = vec4(1,0,0,0);
+        fs_uv.x += fract(u_Time * ANIMATION_RATE) / 16.f;
     }
-    //fs_uv = vs_uv;
 
     vec4 modelposition = u_Model * vec4(vs_Pos, 1);  //    Temporarily store the transformed vertex positions for use below
 
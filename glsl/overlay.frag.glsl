@@ -0,0 +1,21 @@
+#version 150
+// ^ Change this to version 130 if you have compatibility issues
+
+// Fragment shader for the overlay: quads with a tile layer show that block tile tinted by
+// their color, the rest are plain color. No lighting.
+
+in vec3 fs_Col;
+in vec4 fs_uv;
+
+uniform sampler2DArray u_Tiles;
+
+out vec4 out_Col;
+
+void main()
+{
+    vec3 color = fs_Col;
+    if (fs_uv.z >= 0.0) {
+        color *= texture(u_Tiles, fs_uv.xyz).rgb;
+    }
+    out_Col = vec4(color, fs_uv.w);
+}
@@ -0,0 +1,20 @@
+#version 150
+// ^ Change this to version 130 if you have compatibility issues
+
+// Vertex shader for the screen-space overlay (see Overlay). Positions are in pixels.
+
+uniform mat4 u_ViewProj;    // Maps pixels to clip space, see Overlay::projection
+
+in vec3 vs_Pos;
+in vec3 vs_Col;
+in vec4 vs_uv;      // xy = position within the tile, z = tile layer or -1, w = alpha
+
+out vec3 fs_Col;
+out vec4 fs_uv;
+
+void main()
+{
+    fs_Col = vs_Col;
+    fs_uv = vs_uv;
+    gl_Position = u_ViewProj * vec4(vs_Pos, 1);
+}
@@ -0,0 +1,144 @@
+#include "benchmark.h"
+#include <terrain/terrain.h>
+#include <memorystats.h>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+const int Benchmark::WARMUP_FRAMES;
+const int Benchmark::DEFAULT_SEED;
+const float Benchmark::FLY_HEIGHT = 12.f;
+
+static const float PATH_SPEED = 0.5f;       // blocks per frame along x
+static const float PATH_SWAY = 48.f;        // how far the path weaves along z
+static const int PATH_PERIOD = 600;         // frames per weave
+static const float PATH_PITCH = -0.35f;     // the camera looks slightly down
+
+Benchmark* Benchmark::fromEnvironment()
+{
+    int frames = qgetenv("CIS277_BENCHMARK").toInt();
+    if (frames <= 0) {
+        return nullptr;
+    }
+    QString output = qgetenv("CIS277_BENCHMARK_OUT");
+    return new Benchmark(frames, output.isEmpty() ? "benchmark.json" : output);
+}
+
+Benchmark::Benchmark(int frames, const QString &output)
+    : frames(frames), warmup(WARMUP_FRAMES), output(output)
+{
+    samples.reserve(frames);
+}
+
+int Benchmark::pathFrame() const
+{
+    return samples.size();
+}
+
+glm::vec3 Benchmark::offset(int t) const
+{
+    float phase = TWO_PI * t / PATH_PERIOD;
+    return glm::vec3(PATH_SPEED * t, 0, PATH_SWAY * sin(phase));
+}
+
+glm::vec3 Benchmark::direction(int t) const
+{
+    // Along the path's tangent
+    float phase = TWO_PI * t / PATH_PERIOD;
+    glm::vec3 tangent(PATH_SPEED, 0, PATH_SWAY * TWO_PI / PATH_PERIOD * cos(phase));
+    return glm::normalize(glm::normalize(tangent) + glm::vec3(0, PATH_PITCH, 0));
+}
+
+void Benchmark::setRenderer(const QString &renderer)
+{
+    this->renderer = renderer;
+}
+
+void Benchmark::record(double cpu_ms, int chunks, qint64 triangles)
+{
+    if (warmup > 0) {
+        warmup--;
+        return;
+    }
+    if (!finished()) {
+        Frame frame = {cpu_ms, chunks, triangles, 0, 0};
+        for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+            MemorySubsystem s = (MemorySubsystem) i;
+            (MemoryStats::onGpu(s) ? frame.gpu_bytes : frame.cpu_bytes) += MemoryStats::bytes(s);
+        }
+        samples.push_back(frame);
+    }
+}
+
+bool Benchmark::finished() const
+{
+    return samples.size() >= frames;
+}
+
+// Nearest-rank percentile of sorted values
+static double percentile(const QVector<double> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    int rank = (int) ceil(p / 100.0 * sorted.size());
+    return sorted[std::max(0, std::min(rank - 1, sorted.size() - 1))];
+}
+
+bool Benchmark::write() const
+{
+    QVector<double> times;
+    double total = 0;
+    QJsonArray per_frame;
+    for (const Frame &f : samples) {
+        times.push_back(f.cpu_ms);
+        total += f.cpu_ms;
+        QJsonObject frame;
+        frame["cpu_ms"] = f.cpu_ms;
+        frame["chunks"] = f.chunks;
+        frame["triangles"] = (double) f.triangles;
+        frame["cpu_bytes"] = (double) f.cpu_bytes;
+        frame["gpu_bytes"] = (double) f.gpu_bytes;
+        per_frame.append(frame);
+    }
+    std::sort(times.begin(), times.end());
+
+    QJsonObject frame_ms;
+    frame_ms["mean"] = times.isEmpty() ? 0 : total / times.size();
+    frame_ms["min"] = times.isEmpty() ? 0 : times.first();
+    frame_ms["p50"] = percentile(times, 50);
+    frame_ms["p90"] = percentile(times, 90);
+    frame_ms["p95"] = percentile(times, 95);
+    frame_ms["p99"] = percentile(times, 99);
+    frame_ms["max"] = times.isEmpty() ? 0 : times.last();
+
+    // Where the memory is at the end of the run, and at most during it
+    QJsonObject memory;
+    for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+        MemorySubsystem s = (MemorySubsystem) i;
+        QJsonObject entry;
+        entry["bytes"] = (double) MemoryStats::bytes(s);
+        entry["objects"] = (double) MemoryStats::objects(s);
+        entry["peak_bytes"] = (double) MemoryStats::peakBytes(s);
+        entry["gpu"] = MemoryStats::onGpu(s);
+        memory[MemoryStats::name(s)] = entry;
+    }
+
+    QJsonObject report;
+    report["frames"] = samples.size();
+    report["warmup_frames"] = WARMUP_FRAMES;
+    report["seed"] = (double) Terrain::seed;
+    report["renderer"] = renderer;
+    report["frame_ms"] = frame_ms;
+    report["memory"] = memory;
+    report["per_frame"] = per_frame;
+
+    QFile file(output);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(report).toJson());
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <la.h>
+#include <QString>
+#include <QVector>
+
+// A scripted fly-through that measures the renderer with nobody at the controls. Set
+// CIS277_BENCHMARK to the number of frames to record (asan-run.sh -b does this); MyGL then
+// flies the camera along a fixed path over a world generated from a fixed seed, one step per
+// frame, and writes the results as JSON to CIS277_BENCHMARK_OUT (benchmark.json by default).
+class Benchmark
+{
+public:
+    static const int WARMUP_FRAMES = 30;    // drawn at the start of the path, not recorded
+    static const int DEFAULT_SEED = 277;    // terrain seed when CIS277_SEED isn't set
+    static const float FLY_HEIGHT;          // blocks above the terrain
+
+    // The benchmark requested by the environment, or nullptr
+    static Benchmark* fromEnvironment();
+
+    Benchmark(int frames, const QString &output);
+
+    // Index along the path of the next frame; stays at 0 during the warmup
+    int pathFrame() const;
+    // Horizontal offset of the camera from where the path starts, at path frame t
+    glm::vec3 offset(int t) const;
+    // Direction the camera looks at path frame t
+    glm::vec3 direction(int t) const;
+
+    void setRenderer(const QString &renderer);
+    void record(double cpu_ms, int chunks, qint64 triangles);
+    bool finished() const;
+    // Writes the summary and every recorded frame; false if the file can't be written
+    bool write() const;
+
+private:
+    struct Frame {
+        double cpu_ms;      // updating the scene and drawing it, through glFinish
+        int chunks;
+        qint64 triangles;
+        qint64 cpu_bytes, gpu_bytes;    // MemoryStats totals at the end of the frame
+    };
+
+    int frames;
+    int warmup;             // warmup frames left
+    QString output;
+    QString renderer;
+    QVector<Frame> samples;
+};
+
+#endif // BENCHMARK_H
@@ -5,10 +5,7 @@
 #include <QMap>
 #include <QVector>
 #include <QChar>
-#include "openGL/drawable.h"
-#include "scene/geometry/segment.h"
-#include "scene/geometry/cylinder.h"
-#include "scene/geometry/cube.h"
+#include <la.h>
 
 struct LPair_t {
     bool draw;
@@ -0,0 +1,369 @@
+#include "jobs.h"
+#include "mpscqueue.h"
+#include <QSemaphore>
+#include <QThread>
+#include <QtAlgorithms>
+#include <QVector>
+#include <atomic>
+
+const int JobSystem::DEQUE_CAPACITY;
+
+// Reference counted: by handles, by the deque holding it, by its children and by the jobs it
+// holds back. blockers counts the dependencies still running plus one until it is submitted
+struct Job {
+    std::function<void()> work;
+    std::atomic<int> refs{1};
+    std::atomic<int> unfinished{1};     // itself and its unfinished children
+    std::atomic<int> blockers{1};
+    std::atomic<bool> done{false};
+    Job *parent = nullptr;
+    QVector<Job*> continuations;        // held back by this job; fixed once it is submitted
+};
+
+namespace {
+
+void retain(Job *job)
+{
+    job->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void release(Job *job)
+{
+    if (job->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete job;
+    }
+}
+
+// Chase-Lev deque of ready jobs, after Lê et al., "Correct and Efficient Work-Stealing for
+// Weak Memory Models". The owning thread pushes and pops at the bottom; any thread may steal
+// from the top. Only the last job left is contended, and a compare-and-swap on top settles it
+class JobDeque
+{
+public:
+    bool push(Job *job)
+    {
+        qint64 b = bottom.load(std::memory_order_relaxed);
+        qint64 t = top.load(std::memory_order_acquire);
+        if (b - t >= JobSystem::DEQUE_CAPACITY) {
+            return false;
+        }
+        ring[b & MASK].store(job, std::memory_order_relaxed);
+        // Publishes the job to thieves, which read bottom with acquire
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    Job* pop()
+    {
+        qint64 b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        qint64 t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job *job = ring[b & MASK].load(std::memory_order_relaxed);
+        if (t == b) {
+            // The last job: whoever moves top past it gets it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* steal()
+    {
+        qint64 t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        qint64 b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Job *job = ring[t & MASK].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+private:
+    static const qint64 MASK = JobSystem::DEQUE_CAPACITY - 1;
+
+    std::atomic<qint64> top{0};
+    std::atomic<qint64> bottom{0};
+    std::atomic<Job*> ring[JobSystem::DEQUE_CAPACITY];
+};
+
+// Fixed between start and stop, so workers read them without synchronizing. Deque 0 belongs
+// to the main thread
+QVector<JobDeque*> deques;
+QVector<QThread*> workers;
+std::atomic<bool> running{false};
+// Workers about to block on wakeups; submit only posts wakeups while this is non-zero
+std::atomic<int> sleeping{0};
+QSemaphore wakeups;
+
+MpscQueue<std::function<void()>> main_queue;
+
+// Index of the calling thread's deque, -1 on threads the system doesn't own
+thread_local int local_index = -1;
+thread_local quint32 steal_seed = 0x9e3779b9;
+
+}
+
+class JobWorker : public QThread
+{
+public:
+    explicit JobWorker(int index) : index(index) {}
+
+protected:
+    void run() override
+    {
+        JobSystem::workerLoop(index);
+    }
+
+private:
+    int index;
+};
+
+JobHandle::JobHandle(Job *job) : job(job) {}
+
+JobHandle::JobHandle(const JobHandle &other) : job(other.job)
+{
+    if (job) {
+        retain(job);
+    }
+}
+
+JobHandle& JobHandle::operator=(const JobHandle &other)
+{
+    if (other.job) {
+        retain(other.job);
+    }
+    if (job) {
+        release(job);
+    }
+    job = other.job;
+    return *this;
+}
+
+JobHandle::~JobHandle()
+{
+    if (job) {
+        release(job);
+    }
+}
+
+void JobSystem::start(int threads)
+{
+    if (running.load()) {
+        return;
+    }
+    if (threads <= 0) {
+        threads = qMax(1, QThread::idealThreadCount() - 1);
+    }
+    for (int i = 0; i <= threads; i++) {
+        deques.append(new JobDeque());
+    }
+    local_index = 0;
+    running.store(true);
+    for (int i = 1; i <= threads; i++) {
+        QThread *worker = new JobWorker(i);
+        worker->setObjectName(QString("job worker %1").arg(i));
+        workers.append(worker);
+        worker->start();
+    }
+}
+
+void JobSystem::stop()
+{
+    if (!running.load()) {
+        return;
+    }
+    running.store(false);
+    wakeups.release(workers.size());
+    for (QThread *worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+    workers.clear();
+    // Jobs still queued run here, so they are freed and whatever depends on them finishes.
+    // They can only queue more jobs on this thread's deque, which the loop also drains
+    while (runOne()) {
+    }
+    qDeleteAll(deques);
+    deques.clear();
+    local_index = -1;
+}
+
+int JobSystem::threadCount()
+{
+    return workers.size() + 1;
+}
+
+JobHandle JobSystem::create(const std::function<void()> &work, const JobHandle &parent)
+{
+    Job *job = new Job();
+    job->work = work;
+    if (parent.job) {
+        parent.job->unfinished.fetch_add(1, std::memory_order_relaxed);
+        retain(parent.job);
+        job->parent = parent.job;
+    }
+    return JobHandle(job);
+}
+
+void JobSystem::depend(const JobHandle &after, const JobHandle &before)
+{
+    after.job->blockers.fetch_add(1, std::memory_order_relaxed);
+    retain(after.job);
+    before.job->continuations.append(after.job);
+}
+
+void JobSystem::submit(const JobHandle &job)
+{
+    if (job.job->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(job.job);
+    }
+}
+
+bool JobSystem::finished(const JobHandle &job)
+{
+    return job.job->done.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const JobHandle &job)
+{
+    while (!finished(job)) {
+        if (!runOne()) {
+            QThread::yieldCurrentThread();
+        }
+    }
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int, int)> &body)
+{
+    if (count <= grain || threadCount() == 1) {
+        if (count > 0) {
+            body(0, count);
+        }
+        return;
+    }
+    JobHandle root = create([]() {});
+    for (int first = 0; first < count; first += grain) {
+        int end = qMin(first + grain, count);
+        submit(create([&body, first, end]() {
+            body(first, end);
+        }, root));
+    }
+    submit(root);
+    wait(root);
+}
+
+void JobSystem::runOnMainThread(const std::function<void()> &work)
+{
+    main_queue.push(work);
+}
+
+int JobSystem::runMainThreadJobs()
+{
+    int count = 0;
+    std::function<void()> work;
+    while (main_queue.pop(work)) {
+        work();
+        count++;
+    }
+    return count;
+}
+
+void JobSystem::schedule(Job *job)
+{
+    retain(job);
+    if (local_index < 0 || !deques.at(local_index)->push(job)) {
+        execute(job);
+        return;
+    }
+    // Pairs with the fence in workerLoop: either the worker sees the job or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) > 0) {
+        wakeups.release();
+    }
+}
+
+void JobSystem::execute(Job *job)
+{
+    job->work();
+    // Drops whatever the work captured now rather than when the last handle goes
+    job->work = std::function<void()>();
+    finish(job);
+    release(job);
+}
+
+void JobSystem::finish(Job *job)
+{
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    job->done.store(true, std::memory_order_release);
+    for (Job *continuation : job->continuations) {
+        if (continuation->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(continuation);
+        }
+        release(continuation);
+    }
+    job->continuations.clear();
+    if (job->parent) {
+        finish(job->parent);
+        release(job->parent);
+        job->parent = nullptr;
+    }
+}
+
+// Runs a job from the calling thread's own deque, or else one stolen from another thread's
+bool JobSystem::runOne()
+{
+    Job *job = local_index >= 0 ? deques.at(local_index)->pop() : nullptr;
+    int count = deques.size();
+    if (!job && count > 0) {
+        steal_seed ^= steal_seed << 13;
+        steal_seed ^= steal_seed >> 17;
+        steal_seed ^= steal_seed << 5;
+        int first = steal_seed % count;
+        for (int i = 0; i < count && !job; i++) {
+            int victim = (first + i) % count;
+            if (victim != local_index) {
+                job = deques.at(victim)->steal();
+            }
+        }
+    }
+    if (!job) {
+        return false;
+    }
+    execute(job);
+    return true;
+}
+
+void JobSystem::workerLoop(int index)
+{
+    local_index = index;
+    steal_seed = (steal_seed ^ (index * 0x85ebca6bu)) | 1;
+    while (running.load(std::memory_order_acquire)) {
+        if (runOne()) {
+            continue;
+        }
+        sleeping.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // A job pushed before the fence is found here; one pushed after it sees us sleeping
+        if (runOne()) {
+            sleeping.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (running.load(std::memory_order_acquire)) {
+            wakeups.acquire();
+        }
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <QtGlobal>
+#include <functional>
+
+struct Job;
+class JobWorker;
+
+// Shared reference to a job; the job is freed once it has run and nothing refers to it
+class JobHandle
+{
+public:
+    JobHandle() : job(nullptr) {}
+    JobHandle(const JobHandle &other);
+    JobHandle& operator=(const JobHandle &other);
+    ~JobHandle();
+
+    bool isNull() const { return !job; }
+
+private:
+    explicit JobHandle(Job *job);
+    Job *job;
+
+    friend class JobSystem;
+};
+
+// Work-stealing job scheduler. Each worker thread, and the thread that started the system,
+// owns a deque of ready jobs: it pushes and pops at one end, and idle threads steal from the
+// other end of someone else's, so scheduling takes no lock. Threads only block when there is
+// nothing to steal.
+//
+// A job runs once it has been submitted and every job it depends on has finished. It finishes
+// once its work and all of its children are done, which is when the jobs depending on it
+// become ready. Work that needs the GL context goes to the main thread queue instead, which
+// the thread that draws drains each frame.
+class JobSystem
+{
+public:
+    // Capacity of each deque, a power of two; past it, submitted jobs run on the spot
+    static const int DEQUE_CAPACITY = 4096;
+
+    // Starts the workers, one per core besides the calling thread when threads is 0. The
+    // calling thread becomes the main thread. Until then, jobs run on the thread submitting them
+    static void start(int threads = 0);
+    // Waits for the workers to finish what they are running and stops them, then runs the jobs
+    // still queued on the calling thread
+    static void stop();
+    // Threads that run jobs, the main thread included
+    static int threadCount();
+
+    // A job that runs work when submitted and ready. A parent does not finish before its
+    // children, so children must be created before their parent finishes, e.g. by its work
+    static JobHandle create(const std::function<void()> &work, const JobHandle &parent = JobHandle());
+    // Holds after back until before has finished. Neither may have been submitted yet
+    static void depend(const JobHandle &after, const JobHandle &before);
+    // Queues the job on the calling thread's deque once its dependencies are done. From
+    // threads the system doesn't own, a ready job runs right away instead
+    static void submit(const JobHandle &job);
+    static bool finished(const JobHandle &job);
+    // Runs other jobs until job has finished
+    static void wait(const JobHandle &job);
+
+    // Runs body over [0, count) in jobs of up to grain indices each and waits for them. body
+    // is given the first index and the end of its range
+    static void parallelFor(int count, int grain, const std::function<void(int, int)> &body);
+
+    // Queues work to run on the main thread the next time it calls runMainThreadJobs. Safe
+    // from any thread
+    static void runOnMainThread(const std::function<void()> &work);
+    // Runs the main thread work queued so far; returns how many items ran
+    static int runMainThreadJobs();
+
+private:
+    static void schedule(Job *job);
+    static void execute(Job *job);
+    static void finish(Job *job);
+    static bool runOne();
+    static void workerLoop(int index);
+
+    friend class JobWorker;
+};
+
+#endif // JOBS_H
@@ -1,4 +1,8 @@
 #include <mainwindow.h>
+#include <benchmark.h>
+#include <terrain/terrain.h>
+#include <trace.h>
+#include <jobs.h>
 
 #include <QApplication>
 #include <QSurfaceFormat>
@@ -36,11 +40,33 @@ int main(int argc, char *argv[])
         format.setSamples(0);
     }
 
+    // The benchmark flies through the same world every run and draws as fast as it can
+    bool benchmarking = qgetenv("CIS277_BENCHMARK").toInt() > 0;
+    if (benchmarking) {
+        format.setSwapInterval(0);
+    }
+    QByteArray seed = qgetenv("CIS277_SEED");
+    if (!seed.isEmpty()) {
+        Terrain::seed = seed.toUInt();
+    } else if (benchmarking) {
+        Terrain::seed = Benchmark::DEFAULT_SEED;
+    }
+
     QSurfaceFormat::setDefaultFormat(format);
     debugFormatVersion();
 
+    // Chunk generation, meshing and edits run as jobs on every core
+    JobSystem::start();
+
     MainWindow w;
     w.show();
 
-    return a.exec();
+    int result = a.exec();
+    JobSystem::stop();
+    // CIS277_TRACE names a file to write the event trace to on exit
+    QString trace = qgetenv("CIS277_TRACE");
+    if (!trace.isEmpty() && !Trace::write(trace)) {
+        qWarning() << "Couldn't write the event trace to" << trace;
+    }
+    return result;
 }
@@ -1,6 +1,5 @@
 #include "mainwindow.h"
 #include <ui_mainwindow.h>
-#include <ui_hud.h>
 #include <cameracontrolshelp.h>
 
 
@@ -8,18 +7,9 @@ MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow) {
     ui->setupUi(this);
-//    ui->mygl->setFocus();
-//    ui->stackedWidget->setst
-    MyGL *gl = new MyGL();
-    gl->parentView = this->ui->graphicsView;
-    HUD *hud = new HUD();
-    hud->setFocusPolicy(Qt::ClickFocus);
-    this->ui->graphicsView->setScene(new QGraphicsScene(this->ui->graphicsView));
-    this->ui->graphicsView->scene()->addWidget(gl);
-    this->ui->graphicsView->scene()->addWidget(hud);
-    this->ui->graphicsView->gl = gl;
-    this->ui->graphicsView->hud = hud;
-    QObject::connect(this->ui->loadHeightmap, &QPushButton::clicked, gl, &MyGL::slot_loadImage);
+    // MyGL draws its own HUD, see Overlay
+    ui->mygl->setFocus();
+    QObject::connect(this->ui->loadHeightmap, &QPushButton::clicked, ui->mygl, &MyGL::slot_loadImage);
 }
 
 MainWindow::~MainWindow()
@@ -0,0 +1,61 @@
+#include "memorystats.h"
+#include <atomic>
+
+static const char *NAMES[MEMORY_SUBSYSTEMS] = {
+    "chunk cells", "chunk meshes", "octree", "terrain", "heightmap", "gpu chunk arena"
+};
+
+static std::atomic<qint64> byte_counts[MEMORY_SUBSYSTEMS];
+static std::atomic<qint64> object_counts[MEMORY_SUBSYSTEMS];
+static std::atomic<qint64> peak_bytes[MEMORY_SUBSYSTEMS];
+
+const char* MemoryStats::name(MemorySubsystem s)
+{
+    return NAMES[s];
+}
+
+bool MemoryStats::onGpu(MemorySubsystem s)
+{
+    return s == MEM_GPU_CHUNK_ARENA;
+}
+
+void MemoryStats::add(MemorySubsystem s, qint64 bytes, qint64 objects)
+{
+    qint64 total = byte_counts[s].fetch_add(bytes) + bytes;
+    object_counts[s].fetch_add(objects);
+    qint64 peak = peak_bytes[s].load();
+    while (total > peak && !peak_bytes[s].compare_exchange_weak(peak, total)) {}
+}
+
+qint64 MemoryStats::bytes(MemorySubsystem s)
+{
+    return byte_counts[s].load();
+}
+
+qint64 MemoryStats::objects(MemorySubsystem s)
+{
+    return object_counts[s].load();
+}
+
+qint64 MemoryStats::peakBytes(MemorySubsystem s)
+{
+    return peak_bytes[s].load();
+}
+
+MemoryGauge::MemoryGauge(MemorySubsystem s)
+    : subsystem(s), reported_bytes(0), reported_objects(0)
+{}
+
+MemoryGauge::~MemoryGauge()
+{
+    set(0, 0);
+}
+
+void MemoryGauge::set(qint64 bytes, qint64 objects)
+{
+    if (bytes != reported_bytes || objects != reported_objects) {
+        MemoryStats::add(subsystem, bytes - reported_bytes, objects - reported_objects);
+        reported_bytes = bytes;
+        reported_objects = objects;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <QtGlobal>
+
+// Owners of tracked memory. The GPU entries estimate buffer storage from the sizes passed to
+// glBufferData; the CPU entries estimate container storage, overhead included
+enum MemorySubsystem {
+    MEM_CHUNK_CELLS = 0,    // ChunkData::cells
+    MEM_CHUNK_MESHES,       // meshes built on the CPU and not uploaded yet
+    MEM_OCTREE,             // OctNode objects
+    MEM_TERRAIN,            // Terrain's gradient and height caches
+    MEM_HEIGHTMAP,          // Scene::heightmap, from imported images
+    MEM_GPU_CHUNK_ARENA,    // the chunk arena's vertex, index, face and origin buffers
+    MEMORY_SUBSYSTEMS
+};
+
+// Byte and object counters per subsystem, updated by the owners as they allocate and free.
+// Safe to update from any thread
+class MemoryStats
+{
+public:
+    static const char* name(MemorySubsystem s);
+    static bool onGpu(MemorySubsystem s);
+
+    // Negative amounts record frees
+    static void add(MemorySubsystem s, qint64 bytes, qint64 objects);
+    static qint64 bytes(MemorySubsystem s);
+    static qint64 objects(MemorySubsystem s);
+    // Largest byte count seen since startup
+    static qint64 peakBytes(MemorySubsystem s);
+};
+
+// Keeps a subsystem's counters in step with a size its owner recomputes, for containers that
+// are cheaper to measure than to track entry by entry. Removes what it reported when destroyed
+class MemoryGauge
+{
+public:
+    explicit MemoryGauge(MemorySubsystem s);
+    ~MemoryGauge();
+    MemoryGauge(const MemoryGauge&) = delete;
+    MemoryGauge& operator=(const MemoryGauge&) = delete;
+    void set(qint64 bytes, qint64 objects);
+
+private:
+    MemorySubsystem subsystem;
+    qint64 reported_bytes, reported_objects;
+};
+
+#endif // MEMORYSTATS_H
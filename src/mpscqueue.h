@@ -0,0 +1,64 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+
+// Unbounded queue that any number of threads push to and a single thread pops from, without a
+// lock (Vyukov's node-based MPSC queue). A push swaps itself in as the newest node and then
+// links the node before it to it; until that link is made the consumer sees the queue end
+// there, so a push that is still in progress shows up on a later pop.
+template <class T>
+class MpscQueue
+{
+public:
+    MpscQueue() : newest(new Node()), oldest(newest.load()) {}
+    ~MpscQueue()
+    {
+        T value;
+        while (pop(value)) {}
+        delete oldest;
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Safe from any thread
+    void push(const T &value)
+    {
+        Node *node = new Node();
+        node->value = value;
+        Node *previous = newest.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // Only from the consuming thread. False when nothing is ready
+    bool pop(T &value)
+    {
+        Node *next = oldest->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        // next becomes the placeholder at the front once its value is taken
+        value = next->value;
+        next->value = T();
+        delete oldest;
+        oldest = next;
+        return true;
+    }
+
+    // Only from the consuming thread
+    bool isEmpty() const
+    {
+        return !oldest->next.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value = T();
+    };
+
+    std::atomic<Node*> newest;  // producers append here
+    Node *oldest;               // placeholder before the next value to pop, owned by the consumer
+};
+
+#endif // MPSCQUEUE_H
@@ -7,22 +7,45 @@
 #include <QXmlStreamReader>
 #include <QFileDialog>
 #include <QTime>
+#include <QScreen>
+#include <QGuiApplication>
+#include <jobs.h>
+#include <openGL/tilearray.h>
+#include <soundmanager.h>
+#include <trace.h>
+#include <algorithm>
 
-int MyGL::frame = 0;
 int MyGL::time = 0;
 
 #define SHIFT_DISTANCE 16
+static const float WALK_SPEED = 4.3f;      // blocks per second
+static const float SPRINT_FACTOR = 5.f;
+static const float MAX_FRAME_TIME = 0.25f; // longer frames are clamped so physics can't spiral
+static const float VIEW_DISTANCE = 512.f;
+static const float OCCLUDER_DISTANCE = 96.f;   // only chunks this close are rasterized as occluders
+static const int MAX_OCCLUDERS = 48;
+// Chunks farther than this use coarser meshes. The generated window reaches about 100 blocks
+// from the camera, so levels 1 and 2 both cover part of it
+static const float LOD_DISTANCE = 40.f;
+static const float FAR_FIELD_NEAR_CLIP = 4.f;   // the far field never comes closer than the loaded chunks
+static const QString BLOCK_KEYS = "!@#$%^&";    // shifted number keys, in Texture order
 MyGL::MyGL(QWidget *parent)
-    : GLWidget277(parent), filename("")
+    : GLWidget277(parent), filename(""), benchmark(Benchmark::fromEnvironment())
 {
     setFocusPolicy(Qt::ClickFocus);
+    // The far field samples the terrain out to its extent; seeds beyond it are dropped
+    scene.terrain.setKeepDistance(far_field.extent());
 }
 
 MyGL::~MyGL()
 {
     makeCurrent();
-    vao.destroy();
     delete scene.octree;
+    chunk_arena.destroy(*this);
+    terrain_queries[0].destroy();
+    terrain_queries[1].destroy();
+    delete tile_array;
+    delete benchmark;
 }
 
 void MyGL::initializeGL()
@@ -45,29 +68,45 @@ void MyGL::initializeGL()
 
     printGLErrorLog();
 
-    // Create a Vertex Attribute Object
-    vao.create();
-    gltexture = new QOpenGLTexture(QImage(":/minecraft_textures_all.png"));
+    QImage atlas(":/minecraft_textures_all.png");
+    gltexture = new QOpenGLTexture(atlas);
+    tile_array = TileArray::create(atlas);
 
     // Create and set up the diffuse shader
     prog_lambert.create(":/glsl/lambert.vert.glsl", ":/glsl/lambert.frag.glsl");
-    // Create and set up the flat-color shader
-    prog_flat.create(":/glsl/flat.vert.glsl", ":/glsl/flat.frag.glsl");
+    // Chunk meshes live in the arena and are positioned by the vertex shader
+    prog_chunk.create(":/glsl/chunk.vert.glsl", ":/glsl/chunk.frag.glsl");
+    prog_chunk_faces.create(":/glsl/chunkface.vert.glsl", ":/glsl/chunk.frag.glsl");
+    prog_overlay.create(":/glsl/overlay.vert.glsl", ":/glsl/overlay.frag.glsl");
 
     prog_lambert.setUVImage(gltexture);
-    prog_flat.setUVImage(gltexture);
+    prog_chunk.setTileArray(tile_array);
+    prog_chunk_faces.setTileArray(tile_array);
+    prog_overlay.setTileArray(tile_array);
 
-    geom_cube.create();
-
-    // We have to have a VAO bound in OpenGL 3.2 Core. But if we're not
-    // using multiple VAOs, we can just bind one once.
-    vao.bind();
+    chunk_arena.create(*this);
+    // Without timer query support the GPU phase just stays at zero
+    terrain_queries[0].create();
+    terrain_queries[1].create();
 
-    cross.create();
+    geom_cube.create();
+    overlay.setInventory(&inventory);
 
     //timer = QTimer(this);
+    // Tick at the display's refresh rate; the timer stops itself whenever nothing is changing
+    QScreen *screen = QGuiApplication::primaryScreen();
+    qreal refresh_rate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setInterval(qMax(1, qRound(1000.0 / refresh_rate)));
+    if (benchmark) {
+        // Every frame is rendered as soon as the last one is done
+        timer.setInterval(0);
+        benchmark->setRenderer(reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    }
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerUpdate()));
-    timer.start(17);
+    timer.start();
+    physics_clock.start();
+    animation_clock.start();
 
     //Test scene data initialization
     scene.CreateNewChunks();
@@ -85,7 +124,9 @@ void MyGL::resizeGL(int w, int h)
 
     // Upload the projection matrix
     prog_lambert.setViewProjMatrix(viewproj);
-    prog_flat.setViewProjMatrix(viewproj);
+    prog_chunk.setViewProjMatrix(viewproj);
+    prog_chunk_faces.setViewProjMatrix(viewproj);
+    overlay.resize(w, h);
 
     printGLErrorLog();
 }
@@ -94,6 +135,14 @@ void MyGL::resizeGL(int w, int h)
 // For example, when the function updateGL is called, paintGL is called implicitly.
 void MyGL::paintGL()
 {
+    TraceScope trace("frame", "frame");
+    frame_pending = false;
+    // Qt may have changed GL bindings between frames
+    ShaderProgram::resetStateCache();
+    ShaderProgram::resetTriangleCount();
+    animateTextures();
+    overlay.refresh();
+
     // Clear the screen so that we only see newly drawn images
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -101,40 +150,310 @@ void MyGL::paintGL()
 
     // Update the viewproj matrix
     prog_lambert.setViewProjMatrix(gl_camera.getViewProj());
-    prog_flat.setViewProjMatrix(gl_camera.getViewProj());
+    prog_chunk.setViewProjMatrix(gl_camera.getViewProj());
+    prog_chunk_faces.setViewProjMatrix(gl_camera.getViewProj());
+    {
+        // Meshes that jobs finished since the last frame, uploaded while the context is current
+        ProfileScope upload_scope(PHASE_UPLOAD);
+        JobSystem::runMainThreadJobs();
+        ChunkMesh::collect(*this, chunk_arena);
+    }
     GLDrawScene();
+    drawOverlay();
+    Profiler::endFrame();
+    if (overlay.profileVisible() || overlay.memoryVisible()) {
+        overlay.invalidate();
+    }
+
+    // Only frames the benchmark moved the camera for count, not repaints Qt asked for
+    if (benchmark && frame_clock.isValid()) {
+        // A software rasterizer does its work when the commands are flushed, so the frame
+        // isn't done until glFinish returns
+        glFinish();
+        benchmark->record(frame_clock.nsecsElapsed() / 1e6, draw_slots.size(), ShaderProgram::trianglesDrawn());
+        frame_clock.invalidate();
+        if (benchmark->finished()) {
+            if (!benchmark->write()) {
+                qWarning() << "Couldn't write the benchmark results";
+            }
+            QApplication::quit();
+        }
+    }
+}
 
-    //draw the center of the gl lines
+// The crosshair and inventory, blended over the scene in one draw call
+void MyGL::drawOverlay()
+{
     glDisable(GL_DEPTH_TEST);
-    //MODEL matrix is always identity so we are at the untransformed space of the cross
-    prog_flat.setViewProjMatrix(glm::mat4(1.0f));
-    prog_flat.setModelMatrix(glm::mat4(1.0f));
-    prog_flat.draw(*this, cross);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE);
+    prog_overlay.setViewProjMatrix(overlay.projection());
+    prog_overlay.draw(*this, overlay);
+    glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
 }
 
-// Used to determine whether a chunk is too far away to be rendered
-// This can definitely be more efficient, it still checks every node right now
-float MyGL::distanceToEye(Point3 p)
+// Used to determine whether a node is too far away to be rendered
+// Returns the distance from the eye to the closest point of the node's box
+float MyGL::distanceToEye(const glm::vec3 &bmin, const glm::vec3 &bmax)
 {
-    return glm::distance(p.toVec3(), gl_camera.eye);
+    return glm::distance(glm::clamp(gl_camera.eye, bmin, bmax), gl_camera.eye);
 }
 
-void MyGL::drawChunks(OctNode* node)
+// Walks the octree, rejecting whole subtrees that are outside the view frustum, too far away
+// or outside the generated window. Once a node is known to be fully inside the frustum its
+// children skip the test.
+void MyGL::collectChunks(OctNode* node, const Frustum &frustum, bool inside)
 {
-    if (node->is_leaf && node->chunk && distanceToEye(node->base) <= 512) {
-        prog_lambert.setModelMatrix(glm::translate(glm::mat4(), glm::vec3(node->base.x*16, node->base.y*16, node->base.z*16)));
-        prog_lambert.draw(*this, *(node->chunk));
-    } else {    // Draw its children
+    glm::vec3 bmin = node->base.toVec3() * 16.f;
+    glm::vec3 bmax = bmin + glm::vec3(node->length * 16.f);
+    if (distanceToEye(bmin, bmax) > VIEW_DISTANCE) {
+        return;
+    }
+    // Chunks left behind by shifts stay loaded, but the far field covers everything outside
+    // the window, so drawing them too would put them over nearer far field hills
+    glm::ivec2 window_min = scene.windowMin(), window_max = scene.windowMax();
+    if (bmax.x <= window_min.x || bmin.x >= window_max.x || bmax.z <= window_min.y || bmin.z >= window_max.y) {
+        return;
+    }
+    if (!inside) {
+        Frustum::Result result = frustum.classify(bmin, bmax);
+        if (result == Frustum::OUTSIDE) {
+            return;
+        }
+        inside = result == Frustum::INSIDE;
+    }
+
+    if (node->is_leaf) {
+        if (node->chunk && node->chunk->block_count > 0 &&
+                cave_culler.isReachable(glm::ivec3(node->base.x, node->base.y, node->base.z))) {
+            visible_chunks.append(node);
+        }
+    } else {
         for (OctNode* child : node->children) {
-            drawChunks(child);
+            collectChunks(child, frustum, inside);
+        }
+    }
+}
+
+// Orders every chunk leaf by its distance to the center of the camera's chunk
+void MyGL::sortChunks(const glm::ivec3 &cell)
+{
+    glm::vec3 center = (glm::vec3(cell) + 0.5f) * 16.f;
+    std::vector<std::pair<float, OctNode*>> sorted;
+    QVector<OctNode*> stack;
+    stack.append(scene.octree);
+    while (!stack.isEmpty()) {
+        OctNode* node = stack.takeLast();
+        if (!node->is_leaf) {
+            for (OctNode* child : node->children) {
+                stack.append(child);
+            }
+        } else if (node->chunk) {
+            glm::vec3 bmin = node->base.toVec3() * 16.f;
+            glm::vec3 nearest = glm::clamp(center, bmin, bmin + glm::vec3(16.f));
+            sorted.push_back(std::make_pair(glm::distance(nearest, center), node));
         }
     }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<float, OctNode*> &a, const std::pair<float, OctNode*> &b) {
+        return a.first < b.first;
+    });
+
+    chunk_order.clear();
+    chunk_rank.clear();
+    for (const std::pair<float, OctNode*> &entry : sorted) {
+        chunk_rank.insert(entry.second, chunk_order.size());
+        chunk_order.append(entry.second);
+    }
+    visible_stamp.fill(0, chunk_order.size());
+    order_cell = cell;
+}
+
+// Draws the chunks that survive frustum culling, cave culling and then a coarse CPU
+// occlusion test. Cave culling drops chunks no open path leads to from the camera; then the
+// nearest chunks with solid boundary layers are rasterized into the occlusion buffer, so
+// terrain hidden behind hills or underneath the surface is never submitted.
+// Opaque faces are drawn front to back so early depth testing rejects hidden fragments, then
+// water and lava are blended back to front without writing depth.
+void MyGL::drawChunks()
+{
+    ProfileScope cull_scope(PHASE_CULL);
+    glm::mat4 viewproj = gl_camera.getViewProj();
+    Frustum frustum(viewproj);
+    cave_culler.update(scene, frustum, gl_camera.eye, VIEW_DISTANCE);
+    visible_chunks.clear();
+    collectChunks(scene.octree, frustum, false);
+
+    // The visible chunks are picked out of the persistent order instead of being sorted
+    glm::ivec3 cell = glm::ivec3(glm::floor(gl_camera.eye / 16.f));
+    bool stale = chunk_order.isEmpty() || cell != order_cell;
+    for (int i = 0; i < visible_chunks.size() && !stale; i++) {
+        stale = !chunk_rank.contains(visible_chunks[i]);
+    }
+    if (stale) {
+        sortChunks(cell);
+    }
+    cull_frame++;
+    for (OctNode* node : visible_chunks) {
+        visible_stamp[chunk_rank.value(node)] = cull_frame;
+    }
+    std::vector<std::pair<float, OctNode*>> sorted;
+    sorted.reserve(visible_chunks.size());
+    for (int rank = 0; rank < chunk_order.size(); rank++) {
+        if (visible_stamp[rank] == cull_frame) {
+            OctNode* node = chunk_order[rank];
+            glm::vec3 bmin = node->base.toVec3() * 16.f;
+            sorted.push_back(std::make_pair(distanceToEye(bmin, bmin + glm::vec3(16.f)), node));
+        }
+    }
+
+    occlusion.clear(viewproj, gl_camera.eye);
+    int occluders = 0;
+    for (const std::pair<float, OctNode*> &entry : sorted) {
+        // The order is by distance from the camera's chunk, so farther ones may still follow
+        if (occluders >= MAX_OCCLUDERS) {
+            break;
+        }
+        if (entry.first > OCCLUDER_DISTANCE) {
+            continue;
+        }
+        ChunkData* chunk = entry.second->chunk;
+        glm::vec3 bmin = entry.second->base.toVec3() * 16.f;
+        glm::vec3 bmax = bmin + glm::vec3(16.f);
+        if (chunk->isSolid()) {
+            occlusion.addOccluder(bmin, bmax);
+            occluders++;
+            continue;
+        }
+        // Otherwise each completely filled boundary layer is a one block thick occluder
+        for (int face = 0; face < 6; face++) {
+            if (!(chunk->solid_faces & (1 << face))) {
+                continue;
+            }
+            int axis = face / 2;
+            glm::vec3 lo = bmin, hi = bmax;
+            if (face % 2 == 0) {
+                lo[axis] = hi[axis] - 1;
+            } else {
+                hi[axis] = lo[axis] + 1;
+            }
+            occlusion.addOccluder(lo, hi);
+            occluders++;
+        }
+    }
+
+    // Meshes rebuilt since they were last drawn are moved into the arena here, where the
+    // context is current; then every surviving chunk goes out in one draw call per pass
+    draw_meshes.clear();
+    draw_boxes.clear();
+    for (const std::pair<float, OctNode*> &entry : sorted) {
+        glm::vec3 bmin = entry.second->base.toVec3() * 16.f;
+        if (!occlusion.isOccluded(bmin, bmin + glm::vec3(16.f))) {
+            draw_meshes.append(ChunkMesh::of(*entry.second->chunk));
+            draw_boxes.append(glm::vec4(bmin, entry.first));
+        }
+    }
+    // Changed chunks are meshed by jobs; a later frame collects and uploads the meshes
+    ChunkMesh::remesh(draw_meshes);
+    draw_slots.clear();
+    draw_masks.clear();
+    meshes_pending = false;
+    for (int i = 0; i < draw_meshes.size(); i++) {
+        glm::vec3 bmin = glm::vec3(draw_boxes[i]);
+        glm::vec3 bmax = bmin + glm::vec3(16.f);
+        // Each doubling of LOD_DISTANCE halves the resolution the chunk is meshed at
+        int level = 0;
+        for (float d = LOD_DISTANCE; level < ChunkMesh::LOD_LEVELS - 1 && draw_boxes[i].w > d; d *= 2) {
+            level++;
+        }
+        ChunkMesh *mesh = draw_meshes[i];
+        draw_slots.append(mesh->prepare(*this, chunk_arena, bmin, level));
+        meshes_pending |= mesh->building();
+        // Directions whose faces all point away from the camera are left out
+        draw_masks.append(ChunkData::facingFaces(gl_camera.eye, bmin, bmax));
+    }
+    ProfileScope draw_scope(PHASE_DRAW);
+    part_masks.resize(draw_masks.size());
+    for (int i = 0; i < draw_masks.size(); i++) {
+        part_masks[i] = draw_masks[i] << meshPart(PASS_OPAQUE, 0);
+    }
+    drawChunkParts(draw_slots);
+
+    back_to_front.resize(draw_slots.size());
+    std::reverse_copy(draw_slots.begin(), draw_slots.end(), back_to_front.begin());
+    for (int i = 0; i < draw_masks.size(); i++) {
+        part_masks[i] = draw_masks[draw_masks.size() - 1 - i] << meshPart(PASS_TRANSLUCENT, 0);
+    }
+    glEnable(GL_BLEND);
+    // Leave the destination alpha alone so the window itself never turns translucent
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE);
+    glDepthMask(GL_FALSE);
+    // Every blended block is animated, so this pass decides whether frames must keep coming
+    animated_visible = drawChunkParts(back_to_front) > 0;
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+
+    ProfileScope upload_scope(PHASE_UPLOAD);
+    chunk_arena.maintain(*this);
+}
+
+// Draws the parts in part_masks of the given slots. Chunks meshed before ChunkMesh::pack_faces last
+// changed may still be in the other format, so both kinds of slot are drawn. Returns the number
+// of ranges drawn
+int MyGL::drawChunkParts(const QVector<int> &slots_to_draw)
+{
+    return prog_chunk.draw(*this, chunk_arena, slots_to_draw, part_masks)
+            + prog_chunk_faces.drawFaces(*this, chunk_arena, slots_to_draw, part_masks);
+}
+
+// Draws the terrain beyond the generated window. It is projected with its own near and far
+// planes so depth precision covers its whole range, then the depth buffer is cleared so the
+// chunks drawn afterwards always cover it. Nothing is lost because collectChunks only draws
+// chunks inside the window, which is the far field's hole.
+void MyGL::drawFarField()
+{
+    ProfileScope scope(PHASE_FAR_FIELD);
+    far_field.update(scene, gl_camera.eye, scene.windowMin(), scene.windowMax());
+
+    Camera far_camera(gl_camera);
+    far_camera.near_clip = FAR_FIELD_NEAR_CLIP;
+    far_camera.far_clip = far_field.extent();
+    prog_lambert.setViewProjMatrix(far_camera.getViewProj());
+    prog_lambert.setModelMatrix(glm::mat4(1.0f));
+    for (FarFieldRing &ring : far_field.rings) {
+        prog_lambert.draw(*this, ring);
+    }
+    glClear(GL_DEPTH_BUFFER_BIT);
+    prog_lambert.setViewProjMatrix(gl_camera.getViewProj());
 }
 
 void MyGL::GLDrawScene()
 {
-    drawChunks(scene.octree);
+    collectTerrainQuery(0);
+    collectTerrainQuery(1);
+    // If the query from two frames ago still has no result, this frame goes untimed
+    QOpenGLTimerQuery &query = terrain_queries[terrain_query];
+    bool timed = query.isCreated() && !terrain_query_pending[terrain_query];
+    if (timed) {
+        query.begin();
+    }
+    drawFarField();
+    drawChunks();
+    if (timed) {
+        query.end();
+        terrain_query_pending[terrain_query] = true;
+    }
+    terrain_query = 1 - terrain_query;
+}
+
+// Adds a finished terrain query's time to the profile without waiting for an unfinished one
+void MyGL::collectTerrainQuery(int i)
+{
+    if (terrain_query_pending[i] && terrain_queries[i].isResultAvailable()) {
+        Profiler::add(PHASE_GPU_TERRAIN, terrain_queries[i].waitForResult());
+        terrain_query_pending[i] = false;
+    }
 }
 
 // Given the current camera position, which chunk am I located on?
@@ -152,14 +471,15 @@ void MyGL::slot_loadImage() {
     } else {
         qDebug() << "Loaded image";
         this->filename = fn;
-        update();
+        requestFrame();
     }
 }
 
 void MyGL::keyPressEvent(QKeyEvent *e)
 {
     float amount = 2.0f;
-    if(e->modifiers() & Qt::ShiftModifier){
+    sprint = e->modifiers() & Qt::ShiftModifier;
+    if (sprint) {
         amount = 10.0f;
     }
     Point3 old_pos = getChunkPosition();
@@ -178,12 +498,62 @@ void MyGL::keyPressEvent(QKeyEvent *e)
         gl_camera.fovy += amount;
     } else if (e->key() == Qt::Key_2) {
         gl_camera.fovy -= amount;
+    } else if (sprint && !e->text().isEmpty() && BLOCK_KEYS.indexOf(e->text()) >= 0) {
+        // Shift + a number key selects the block to place. Matched by text because the number
+        // keys aren't ordered sequentially on every keyboard
+        int selected = BLOCK_KEYS.indexOf(e->text());
+        if (selected < Inventory::SLOTS) {
+            inventory.select((Texture) selected);
+            overlay.invalidate();
+        }
+    } else if (e->key() == Qt::Key_R) {
+        Texture removed = destroyBlocks();
+        if (removed != EMPTY) {
+            inventory.give(removed);
+            overlay.invalidate();
+            SoundManager::playOff();
+        } else {
+            SoundManager::playMiss();
+        }
+    } else if (e->key() == Qt::Key_T) {
+        Texture to_add = canAddBlock() ? inventory.take() : EMPTY;
+        if (to_add != EMPTY) {
+            sachaAddBlock(to_add);
+            overlay.invalidate();
+            SoundManager::playOn();
+        } else {
+            SoundManager::playMiss();
+        }
+    } else if (e->key() == Qt::Key_I) {
+        overlay.setInventoryVisible(!overlay.inventoryVisible());
+    } else if (e->key() == Qt::Key_P) {
+        overlay.setProfileVisible(!overlay.profileVisible());
+    } else if (e->key() == Qt::Key_M) {
+        overlay.setMemoryVisible(!overlay.memoryVisible());
+    } else if (e->key() == Qt::Key_J) {
+        if (Trace::write("trace.json")) {
+            qDebug() << "Wrote the event trace to trace.json";
+        } else {
+            qWarning() << "Couldn't write trace.json";
+        }
+    } else if (e->key() == Qt::Key_O) {
+        if (Profiler::dump("profile.txt")) {
+            qDebug() << "Wrote the frame profile to profile.txt";
+        } else {
+            qWarning() << "Couldn't write profile.txt";
+        }
     } else if (e->key() == Qt::Key_C) {
         if (filename != "") {
             QImage image = QImage(filename);
             scene.parseImage(image, gl_camera.eye);
-            update();
+            far_field.invalidate();
+            requestFrame();
         }
+    } else if (e->key() == Qt::Key_V) {
+        // switch chunk meshes between indexed vertices and packed faces drawn by vertex pulling
+        ChunkMesh::pack_faces = !ChunkMesh::pack_faces;
+        scene.remeshChunks();
+        qDebug() << "Packed chunk faces:" << ChunkMesh::pack_faces;
     }
 
     //z direction
@@ -223,6 +593,10 @@ void MyGL::keyPressEvent(QKeyEvent *e)
 
     //enable gravity
     else if (e->key() == Qt::Key_G) {
+        if (!isGravity) {
+            physics.teleport(gl_camera.eye);
+            physics_accumulator = 0.f;
+        }
         isGravity = true;
     }
 
@@ -269,6 +643,13 @@ void MyGL::keyPressEvent(QKeyEvent *e)
         }
     }
     gl_camera.RecomputeAttributes();
+    shiftScene(old_pos);
+    requestFrame();
+}
+
+// Generates new chunks if the camera left the chunk it was in at old_pos
+void MyGL::shiftScene(Point3 old_pos)
+{
     Point3 new_pos = getChunkPosition();
     // We moved to a different chunk
     if (!(old_pos == new_pos)) {
@@ -283,11 +664,17 @@ void MyGL::keyPressEvent(QKeyEvent *e)
             scene.shift(0, 0, -SHIFT_DISTANCE);
         }
     }
-    update();  // Calls paintGL, among other things
 }
 
 void MyGL::keyReleaseEvent(QKeyEvent *e) {
-    if (e->key() == Qt::Key_W) {
+    // Held keys send release/press pairs while repeating; only the real release stops movement
+    if (e->isAutoRepeat()) {
+        return;
+    }
+    if (e->key() == Qt::Key_Shift) {
+        sprint = false;
+    }
+    else if (e->key() == Qt::Key_W) {
         inz = false;
         qDebug() << "w is release";
     }
@@ -310,10 +697,11 @@ void MyGL::keyReleaseEvent(QKeyEvent *e) {
 //        isGravity = false;
 //    }
     gl_camera.RecomputeAttributes();
-    update();
+    requestFrame();
 }
 
 Point3* MyGL::raymarchCast() {
+    TraceScope trace("ray cast", "ray");
     Ray ray_from_center = gl_camera.raycast();
     for (float t = 0.1; t < 32.f; t+=0.1) {
         glm::vec3 new_dir = glm::vec3 (t*ray_from_center.direction.x, t*ray_from_center.direction.y,
@@ -350,7 +738,7 @@ Texture MyGL::destroyBlocks() {
 
     if (cube != nullptr && cube->x != INFINITY) {
         Point3 localchunk = scene.worldToChunk(Point3(cube->x, cube->y, cube->z));
-        Chunk* chunk = scene.getContainingChunk(Point3(cube->x, cube->y, cube->z));
+        ChunkData* chunk = scene.getContainingChunk(Point3(cube->x, cube->y, cube->z));
         if (localchunk.x < chunk->cells.size()) {
             QList<QList<Texture>> ypart = chunk->cells[localchunk.x];
             if (localchunk.y < ypart.size()) {
@@ -359,8 +747,8 @@ Texture MyGL::destroyBlocks() {
                     if (chunk->cells[localchunk.x][localchunk.y][localchunk.z] != EMPTY) {
                         Texture old = chunk->cells[localchunk.x][localchunk.y][localchunk.z];
                         chunk->cells[localchunk.x][localchunk.y][localchunk.z] = EMPTY;
-                        chunk->create();
-                        update();
+                        chunk->update();
+                        requestFrame();
                         return old;
                     }
                 }
@@ -376,7 +764,7 @@ bool MyGL::canAddBlock() {
     Point3* cube = raymarchCast();
     if (cube != nullptr && cube->x != INFINITY) {
         Point3 localchunk = scene.worldToChunk(Point3(cube->x, cube->y, cube->z));
-        Chunk* chunk = scene.getContainingChunk(Point3(cube->x, cube->y, cube->z));
+        ChunkData* chunk = scene.getContainingChunk(Point3(cube->x, cube->y, cube->z));
         if (localchunk.y + 1 > 15) {
             chunk = scene.getContainingChunk(Point3(cube->x, cube->y + 1, cube->z));
         }
@@ -393,279 +781,121 @@ bool MyGL::sachaAddBlock(Texture t) {
     Point3* cube = raymarchCast();
     if (cube != nullptr && cube->x != INFINITY) {
         Point3 localchunk = scene.worldToChunk(Point3(cube->x, cube->y, cube->z));
-        Chunk* chunk = scene.getContainingChunk(Point3(cube->x, cube->y, cube->z));
+        ChunkData* chunk = scene.getContainingChunk(Point3(cube->x, cube->y, cube->z));
         if (localchunk.y + 1 > 15) {
             chunk = scene.getContainingChunk(Point3(cube->x, cube->y + 1, cube->z));
         }
         Texture &pt = chunk->cells[localchunk.x][(int) (localchunk.y+1) % 16][localchunk.z];
         if (pt == EMPTY) {
             pt = t;
-            chunk->create();
-            update();
+            chunk->update();
+            requestFrame();
             return true;
         }
     }
     return false;
 }
 
+// Animation is computed on the GPU from the time; the clock wraps every minute to keep float
+// precision, which is a whole number of animation cycles
 void MyGL::animateTextures() {
-    int remainTime = timer.remainingTime();
-    //timer is active
-    if (remainTime != -1) {
-        int moduolo = frame % 5;
-        prog_lambert.setTimer(moduolo);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
-        frame++;
-    }
+    float seconds = (animation_clock.elapsed() % 60000) / 1000.f;
+    prog_lambert.setTime(seconds);
+    prog_chunk.setTime(seconds);
+    prog_chunk_faces.setTime(seconds);
 }
 
-//COLLISION CODE
-//right is true -> move to right
-//false-> try to move to left
-Point3 MyGL::collisionX(bool right, float time) {
-    float position = time * time * acceleration;
-    //negative
-    if (!right) {
-        gl_camera.TranslateAlongRight(-position);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
-    }
-
-    //posive amt
-    else if (right) {
-        gl_camera.TranslateAlongRight(position);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
-    }
-    //feet
-    return Point3(gl_camera.eye.x, glm::floor(gl_camera.eye.y-1.5), gl_camera.eye.z);
-}
-
-//if up is true we are moving up;
-//else we are trying to move down;
-Point3 MyGL::collisionY(bool up, float time) {
-    //float d_speed = time * acceleration;
-    float position = time * time * acceleration;
-    //negative
-    if (!up) {
-        gl_camera.TranslateAlongUp(-position);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
+// Schedules one repaint, however many times it is called before the frame is drawn, and
+// wakes the frame loop if it went idle
+void MyGL::requestFrame()
+{
+    if (!frame_pending) {
+        frame_pending = true;
+        update();
     }
-    //posive amt
-    else if(up) {
-        gl_camera.TranslateAlongUp(position);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
+    if (!timer.isActive()) {
+        physics_clock.restart();
+        timer.start();
     }
-    //feet
-    return Point3(gl_camera.eye.x, glm::floor(gl_camera.eye.y-1.5), gl_camera.eye.z);
 }
 
-//if look is true we are trying to move towards us
-//is look is false we are trying to move away
-Point3 MyGL::collisionZ(bool look, float time) {
-    float position =  time * time * acceleration;
-    //negative
-    if (!look) {
-        gl_camera.TranslateAlongLook(-position);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
-    }
-
-    //posive amt
-    else if(look) {
-        gl_camera.TranslateAlongLook(position);
-        if (parentView && parentView->scene()) {
-           parentView->scene()->update();
-        }
-    }
-    //feet
-    return Point3(gl_camera.eye.x, glm::floor(gl_camera.eye.y-1.5), gl_camera.eye.z);
+// Desired horizontal velocity from the held movement keys
+glm::vec3 MyGL::walkVelocity()
+{
+    glm::vec3 forward = glm::vec3(gl_camera.look.x, 0, gl_camera.look.z);
+    glm::vec3 right = glm::vec3(gl_camera.right.x, 0, gl_camera.right.z);
+    glm::vec3 wish = (float) (inz - outz) * (glm::length(forward) > 0 ? glm::normalize(forward) : forward)
+            + (float) (rightx - leftx) * (glm::length(right) > 0 ? glm::normalize(right) : right);
+    if (glm::length(wish) == 0) {
+        return wish;
+    }
+    return glm::normalize(wish) * WALK_SPEED * (sprint ? SPRINT_FACTOR : 1.f);
 }
 
-Point3 MyGL::gravity(float time) {
-    float d_speed = time * acceleration;
-    character_velocity.y -= d_speed;
-    if (character_velocity.y < -terminal_v) {
-        character_velocity.y = -terminal_v;
-    }
-    float position = character_velocity.y * time;
-    //qDebug() << position;
-    gl_camera.TranslateAlongUp(position);
-    if (parentView && parentView->scene()) {
-       parentView->scene()->update();
-    }
-    return Point3(gl_camera.eye.x, glm::floor(gl_camera.eye.y-1.5), gl_camera.eye.z);
+// Moves the camera to a new eye position without changing where it looks
+void MyGL::placeCamera(const glm::vec3 &eye)
+{
+    glm::vec3 offset = gl_camera.ref - gl_camera.eye;
+    gl_camera.eye = eye;
+    gl_camera.ref = eye + offset;
+    gl_camera.RecomputeAttributes();
 }
 
-Point3 MyGL::moveCharacter(Point3 character) {
-    float head = character.y + 0.5;
-    float feet = character.y - 1.5;
-    float left = character.x - 0.5;
-    float right = character.x + 0.5;
-    float front = character.z + 0.5;
-    float back = character.z - 0.5;
-
-    float floor_head = glm::floor(head);
-    float floor_feet = glm::floor(feet);
-    float floor_left = glm::floor(left);
-    float floor_right = glm::floor(right);
-    float floor_front = glm::floor(front);
-    float floor_back = glm::floor(back);
-
-    float new_x = character.x;
-    float new_y = character.y;
-    float new_z = character.z;
-
-    //check front
-    for (int i = floor_left; i <= floor_right; i++) {
-        for (int j = floor_feet; j <= floor_head; j++) {
-            if(scene.isFilled(Point3(i, j, floor_front))) {
-                new_z = new_z - (front - floor_front);
-                front = new_z + 0.5;
-                floor_front = glm::floor(front);
-                back = new_z - 0.5;
-                floor_back = glm::floor(back);
-                break;
-            }
-            if (scene.isFilled(Point3(i, j, floor_back))) {
-                new_z = new_z + (glm::ceil(back) - back);
-                front = new_z + 0.5;
-                floor_front = glm::floor(front);
-                back = new_z - 0.5;
-                floor_back = glm::floor(back);
-                break;
-            }
-        }
-    }
-
-
-    //check left
-    for (int i = floor_feet; i <= floor_head; i++) {
-        for (int j = floor_back; j <= floor_front; j++) {
-            if (scene.isFilled(Point3(floor_left, i, j))) {
-                new_x = new_x + (glm::ceil(left) - left);
-                left = new_x - 0.5;
-                floor_left = glm::floor(left);
-                right = new_z + 0.5;
-                floor_right = glm::floor(right);
-                break;
-            }
-            if (scene.isFilled(Point3(floor_right, i, j))) {
-                new_x = new_x - (left - floor_right);
-                left = new_x - 0.5;
-                floor_left = glm::floor(left);
-                right = new_z + 0.5;
-                floor_right = glm::floor(right);
-                break;
-            }
-        }
-    }
-
-
-    //check head
-    for (int i = floor_left; i <= floor_right; i++) {
-        for (int j = floor_back; j <= floor_front; j++) {
-            if(scene.isFilled(Point3(i, floor_head, j))) {
-                new_y = new_y - (head - floor_head);
-                head = new_y + 0.5;
-                floor_head = glm::floor(head);
-                feet = new_y - 1.5;
-                floor_feet = glm::floor(feet);
-                break;
-            }
-            if(scene.isFilled(Point3(i, floor_feet, j))) {
-                new_y = new_y + (glm::ceil(feet) - feet);
-                head = new_y + 0.5;
-                floor_head = glm::floor(head);
-                feet = new_y - 1.5;
-                floor_feet = glm::floor(feet);
-                break;
-            }
-        }
-    }
-
-    return Point3(new_x, new_y, new_z);
+// Moves the camera to the benchmark path's next frame and draws it
+void MyGL::flyBenchmarkPath()
+{
+    frame_clock.start();
+    Point3 old_pos = getChunkPosition();
+    int t = benchmark->pathFrame();
+    glm::vec3 eye = glm::vec3(scene.dimensions[0] / 2, 0, scene.dimensions[2] / 2) + benchmark->offset(t);
+    eye.y = scene.terrainHeight(eye.x, eye.z) + Benchmark::FLY_HEIGHT;
+    gl_camera.eye = eye;
+    gl_camera.ref = eye + benchmark->direction(t);
+    gl_camera.RecomputeAttributes();
+    shiftScene(old_pos);
+    requestFrame();
 }
 
 void MyGL::timerUpdate()
 {
+    if (benchmark) {
+        if (!frame_pending) {
+            flyBenchmarkPath();
+        }
+        return;
+    }
 
-    // This function is called roughly 60 times per second.
-    // Use it to update your scene and then tell it to redraw.
+    // Called once per display refresh while the frame loop is awake. Updates the scene and
+    // requests a frame only when the image would change.
     // (Don't update your scene in paintGL, because it
     // sometimes gets called automatically by Qt.)
 
-    animateTextures();//Animates the textures in the scene
-
-    //1. Read key inputs and move accordingly, ignoring collisions
-    //2. Apply gravity, ignoring collisions
-    //3. Check if your character is inside the terrain and push him/her out
-
-
-    glm::vec3 character = gl_camera.eye;
-    Point3 feet = Point3(character.x, glm::floor(character.y-1.5), character.z);
+    // Physics runs in fixed steps of measured time: a late timer tick runs more
+    // steps instead of moving further per step. The camera is drawn between the
+    // last two steps so motion stays smooth when ticks and steps don't line up.
+    float elapsed = physics_clock.nsecsElapsed() / 1e9f;
+    physics_clock.restart();
 
+    bool moved = false;
     if (isGravity) {
-        if (!scene.isFilled(feet)) {
-            feet = gravity(0.0167f);
-        }
-        else {
-            character_velocity.y = 0;
-        }
-
-    //collision in z
-    //+amount
-    if (inz) {
-        feet = collisionZ(inz, 0.2f);
-    }
-    //-amt
-    if (outz) {
-        feet = collisionZ(!outz, 0.2f);
-    }
-
-    //collision in x
-    if (rightx) {
-        feet = collisionX(rightx, 0.2f);
-    }
-    if (leftx) {
-        feet = collisionX(!leftx, 0.2f);
-    }
-
-    //collision in y
-    if (downy) {
-        feet = collisionY(!downy, 0.2f);
-    }
-    if (upy) {
-        feet = collisionY(upy, 0.2f);
-    }
-
-    if (inz || outz || upy || downy || leftx || rightx) {
-        Point3 new_eye = moveCharacter(Point3(gl_camera.eye.x, gl_camera.eye.y, gl_camera.eye.z));
-        gl_camera.eye.x = new_eye.x;
-        gl_camera.eye.y = new_eye.y;
-        gl_camera.eye.z = new_eye.z;
-        gl_camera.RecomputeAttributes();
-        inz = false;
-        outz = false;
-        upy = false;
-        downy = false;
-        leftx = false;
-        rightx = false;
-    }
-}
-
-
-
-    if (parentView && parentView->scene()) {
-       parentView->scene()->update();
+        Point3 old_pos = getChunkPosition();
+        glm::vec3 old_eye = gl_camera.eye;
+        physics_accumulator += glm::min(elapsed, MAX_FRAME_TIME);
+        glm::vec3 wish = walkVelocity();
+        ProfileScope scope(PHASE_PHYSICS);
+        while (physics_accumulator >= PlayerPhysics::TIMESTEP) {
+            physics.step(scene, wish, true, upy);
+            physics_accumulator -= PlayerPhysics::TIMESTEP;
+        }
+        placeCamera(physics.interpolate(physics_accumulator / PlayerPhysics::TIMESTEP));
+        shiftScene(old_pos);
+        moved = gl_camera.eye != old_eye;
+    }
+
+    if (moved || animated_visible || meshes_pending) {
+        requestFrame();
+    } else if (!isGravity) {
+        // Nothing to simulate or show; input wakes the loop through requestFrame
+        timer.stop();
     }
 }
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
 
 #include <openGL/glwidget277.h>
@@ -9,47 +8,92 @@
 #include <scene/camera.h>
 #include <scene/scene.h>
 #include <scene/geometry/cube.h>
-#include <scene/geometry/chunk.h>
+#include <openGL/chunkmesh.h>
+#include <scene/geometry/farfield.h>
 #include <la.h>
 #include <generators/lparser.h>
 #include <QImage>
 #include <QOpenGLTexture>
+#include <QOpenGLTimerQuery>
 #include <iostream>
 #include <QString>
 
-#include "scene/geometry/cross.h"
+#include "scene/geometry/overlay.h"
+#include "scene/inventory.h"
+#include "scene/physics.h"
+#include "scene/frustum.h"
+#include "scene/occlusion.h"
+#include "scene/cavecull.h"
+#include "benchmark.h"
+#include "profiler.h"
 #include <QTimer>
-#include <QGraphicsView>
+#include <QHash>
+#include <QElapsedTimer>
 
 class MyGL
         : public GLWidget277
 {
     Q_OBJECT
 private:
-    QOpenGLVertexArrayObject vao;
 
     ShaderProgram prog_lambert;
-    ShaderProgram prog_flat;
+    ShaderProgram prog_overlay;     // crosshair and inventory, see Overlay
+    ShaderProgram prog_chunk;
+    ShaderProgram prog_chunk_faces;     // chunk meshes stored as packed faces, see ChunkMesh::pack_faces
 
     Camera gl_camera;//This is a camera we can move around the scene to view it from any angle.
     Cube geom_cube;
 
     QOpenGLTexture* gltexture;
+    QOpenGLTexture* tile_array;     // gltexture split into mipmapped layers for the chunk shaders
 
 
     Scene scene;
+    ChunkArena chunk_arena;
+    OcclusionBuffer occlusion;
+    CaveCuller cave_culler;
+    FarField far_field;
+    QVector<OctNode*> visible_chunks;   // frustum culling output, reused every frame
+    QVector<int> draw_slots;            // arena slots of the chunks drawn this frame, nearest first
+    QVector<ChunkMesh*> draw_meshes;    // meshes of the chunks that survive culling, nearest first
+    QVector<glm::vec4> draw_boxes;      // per surviving chunk, bmin and its distance from the eye
+    QVector<int> draw_masks;            // per drawn chunk, the ChunkFace directions facing the camera
+    QVector<int> back_to_front;         // draw_slots reversed, for the translucent pass
+    QVector<int> part_masks;            // mesh parts drawn per slot in the current pass
+
+    // Leaves holding chunks, nearest to the camera's chunk first. Only re-sorted when the
+    // camera enters another chunk or a chunk appears that isn't in the order yet.
+    QVector<OctNode*> chunk_order;
+    QHash<OctNode*, int> chunk_rank;    // index of each leaf in chunk_order
+    QVector<int> visible_stamp;         // per rank, the last cull_frame the chunk was visible in
+    glm::ivec3 order_cell;
+    int cull_frame = 0;
 
     Point3 getChunkPosition();
-    float distanceToEye(Point3 p);
+    float distanceToEye(const glm::vec3 &bmin, const glm::vec3 &bmax);
     QString filename;
 
+    Inventory inventory;
+    Overlay overlay;
+
+    // GPU time of the terrain passes. Frames alternate between the two queries and a result is
+    // only read once it is available, so timing never stalls the pipeline
+    QOpenGLTimerQuery terrain_queries[2];
+    bool terrain_query_pending[2] = {false, false};
+    int terrain_query = 0;          // the query the next frame uses
+    void collectTerrainQuery(int i);
+
     //week 1 stuff
-    Cross cross;
-//    float time = 0.0;
-    float acceleration = 11.1f;
-    float terminal_v = 50.0;
-    glm::vec3 character_velocity;
+    PlayerPhysics physics;
+    QElapsedTimer physics_clock;
+    float physics_accumulator = 0.f;
+    // Ticks once per display refresh while something changes and stops when the view is idle.
+    // Frames are only requested when the image would differ from the last one
     QTimer timer;
+    QElapsedTimer animation_clock;
+    bool frame_pending = false;     // a repaint has been requested and not drawn yet
+    bool animated_visible = false;  // the last frame drew animated blocks
+    bool meshes_pending = false;    // the last frame drew a chunk whose coarse meshes were still building
     bool leftx = false;
     bool rightx = false;
     bool upy = false;
@@ -57,6 +101,16 @@ private:
     bool inz = false;
     bool outz = false;
     bool isGravity = false;
+    bool sprint = false;
+
+    Benchmark *benchmark;           // set when the environment asks for a benchmark run
+    QElapsedTimer frame_clock;      // times each benchmark frame from its update to glFinish
+
+    glm::vec3 walkVelocity();
+    void placeCamera(const glm::vec3 &eye);
+    void shiftScene(Point3 old_pos);
+    void requestFrame();
+    void flyBenchmarkPath();
 
 public:
     explicit MyGL(QWidget *parent = 0);
@@ -65,7 +119,12 @@ public:
     void initializeGL();
     void resizeGL(int w, int h);
     void paintGL();
-    void drawChunks(OctNode* node);
+    void collectChunks(OctNode* node, const Frustum &frustum, bool inside);
+    void drawChunks();
+    int drawChunkParts(const QVector<int> &slots_to_draw);
+    void sortChunks(const glm::ivec3 &cell);
+    void drawFarField();
+    void drawOverlay();
 
     void SceneLoadDialog();
     void GLDrawScene();
@@ -79,21 +138,11 @@ public:
     bool sachaAddBlock(Texture t);
     bool canAddBlock();
 
-    Point3 collisionX(bool right, float time);
-    Point3 collisionY(bool up, float time);
-    //if look is true we are trying to move towards us
-    //is look is false we are trying to move away
-    Point3 collisionZ(bool look, float time);
-    Point3 moveCharacter(Point3 character);
-
     Point3* raymarchCast();
     OctNode* octreeMarch();
-    static int frame;
-    QGraphicsView *parentView;
     static int time;
     //OctNode* node;
     void animateTextures();
-    Point3 gravity(float time);
     void keyPressEvent(QKeyEvent *e);
     void keyReleaseEvent(QKeyEvent *e);
 
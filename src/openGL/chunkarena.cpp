@@ -0,0 +1,429 @@
+#include "chunkarena.h"
+#include <cstddef>
+
+static const int INITIAL_VERTICES = 1 << 18;
+static const int INITIAL_INDICES = 3 << 17;     // six indices per four vertices
+static const int INITIAL_FACES = 1 << 16;
+static const int INITIAL_SLOTS = 1024;
+
+ChunkArena::ChunkArena()
+    : vao(0), face_vao(0), vertex_buffer(0), index_buffer(0), face_buffer(0), face_texture(0),
+      origin_buffer(0), origin_texture(0),
+      vertex_capacity(0), index_capacity(0), face_capacity(0), origin_capacity(0),
+      used_vertices(0), used_indices(0), used_faces(0), gpu_memory(MEM_GPU_CHUNK_ARENA)
+{}
+
+void ChunkArena::create(GLWidget277 &f)
+{
+    f.glGenVertexArrays(1, &vao);
+    f.glGenVertexArrays(1, &face_vao);
+    f.glGenTextures(1, &face_texture);
+    compact(f, INITIAL_VERTICES, INITIAL_INDICES, INITIAL_FACES);
+
+    origin_capacity = INITIAL_SLOTS;
+    f.glGenBuffers(1, &origin_buffer);
+    f.glBindBuffer(GL_TEXTURE_BUFFER, origin_buffer);
+    f.glBufferData(GL_TEXTURE_BUFFER, origin_capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    f.glGenTextures(1, &origin_texture);
+    f.glBindTexture(GL_TEXTURE_BUFFER, origin_texture);
+    f.glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, origin_buffer);
+    updateMemory();
+}
+
+void ChunkArena::destroy(GLWidget277 &f)
+{
+    f.glDeleteBuffers(1, &vertex_buffer);
+    f.glDeleteBuffers(1, &index_buffer);
+    f.glDeleteBuffers(1, &face_buffer);
+    f.glDeleteTextures(1, &face_texture);
+    f.glDeleteBuffers(1, &origin_buffer);
+    f.glDeleteTextures(1, &origin_texture);
+    f.glDeleteVertexArrays(1, &vao);
+    f.glDeleteVertexArrays(1, &face_vao);
+    vertex_buffer = index_buffer = face_buffer = face_texture = origin_buffer = origin_texture = 0;
+    vao = face_vao = 0;
+    gpu_memory.set(0, 0);
+}
+
+// First fit; the remainder of the range stays in the free list
+bool ChunkArena::allocateRange(QMap<int, int> &free_list, int length, int &offset)
+{
+    if (length == 0) {
+        offset = 0;
+        return true;
+    }
+    for (QMap<int, int>::iterator it = free_list.begin(); it != free_list.end(); ++it) {
+        if (it.value() >= length) {
+            offset = it.key();
+            int remaining = it.value() - length;
+            free_list.erase(it);
+            if (remaining > 0) {
+                free_list.insert(offset + length, remaining);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns a range to the free list, merging it with the free ranges on either side
+void ChunkArena::freeRange(QMap<int, int> &free_list, int offset, int length)
+{
+    if (length == 0) {
+        return;
+    }
+    QMap<int, int>::iterator next = free_list.lowerBound(offset);
+    if (next != free_list.end() && next.key() == offset + length) {
+        length += next.value();
+        next = free_list.erase(next);
+    }
+    if (next != free_list.begin()) {
+        QMap<int, int>::iterator prev = next;
+        --prev;
+        if (prev.key() + prev.value() == offset) {
+            prev.value() += length;
+            return;
+        }
+    }
+    free_list.insert(offset, length);
+}
+
+int ChunkArena::largestRange(const QMap<int, int> &free_list)
+{
+    int largest = 0;
+    for (int length : free_list) {
+        largest = qMax(largest, length);
+    }
+    return largest;
+}
+
+/**
+ * @brief ChunkArena::compact - moves every mesh to the front of freshly allocated buffers
+ * The copies happen on the GPU with glCopyBufferSubData. Indices are relative to their mesh's
+ * first vertex and faces carry their slot rather than a position, so nothing needs rewriting.
+ * @param new_vertex_capacity - size of the new vertex buffer, at least used_vertices
+ * @param new_index_capacity - size of the new index buffer, at least used_indices
+ * @param new_face_capacity - size of the new face buffer, at least used_faces
+ */
+void ChunkArena::compact(GLWidget277 &f, int new_vertex_capacity, int new_index_capacity, int new_face_capacity)
+{
+    vertex_buffer = repack(f, vertex_buffer, new_vertex_capacity, sizeof(ChunkVertex),
+                           &Allocation::first_vertex, &Allocation::vertex_count);
+    index_buffer = repack(f, index_buffer, new_index_capacity, sizeof(GLuint),
+                          &Allocation::first_index, &Allocation::index_count);
+    face_buffer = repack(f, face_buffer, new_face_capacity, sizeof(GLuint),
+                         &Allocation::first_face, &Allocation::face_count);
+    vertex_capacity = new_vertex_capacity;
+    index_capacity = new_index_capacity;
+    face_capacity = new_face_capacity;
+
+    free_vertices.clear();
+    free_indices.clear();
+    free_faces.clear();
+    if (used_vertices < vertex_capacity) {
+        free_vertices.insert(used_vertices, vertex_capacity - used_vertices);
+    }
+    if (used_indices < index_capacity) {
+        free_indices.insert(used_indices, index_capacity - used_indices);
+    }
+    if (used_faces < face_capacity) {
+        free_faces.insert(used_faces, face_capacity - used_faces);
+    }
+    setupVAO(f);
+    f.glBindTexture(GL_TEXTURE_BUFFER, face_texture);
+    f.glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, face_buffer);
+    updateMemory();
+}
+
+// Copies each allocation's range of old_buffer to the front of a new buffer of capacity elements,
+// updates the allocation's first element and returns the new buffer; old_buffer is deleted
+GLuint ChunkArena::repack(GLWidget277 &f, GLuint old_buffer, int capacity, int element_size,
+                          int Allocation::*first, int Allocation::*count)
+{
+    GLuint buffer;
+    f.glGenBuffers(1, &buffer);
+    f.glBindBuffer(GL_COPY_READ_BUFFER, old_buffer);
+    f.glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    f.glBufferData(GL_COPY_WRITE_BUFFER, capacity * element_size, nullptr, GL_STATIC_DRAW);
+    int next = 0;
+    for (Allocation &a : allocations) {
+        if (a.used && a.*count > 0) {
+            f.glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                  a.*first * element_size, next * element_size, a.*count * element_size);
+            a.*first = next;
+            next += a.*count;
+        }
+    }
+    f.glDeleteBuffers(1, &old_buffer);
+    return buffer;
+}
+
+// Points the VAO at the current buffers. Runs only at creation and after compaction, so
+// it restores whatever VAO was bound rather than disturbing the draw state
+void ChunkArena::setupVAO(GLWidget277 &f)
+{
+    GLint previous = 0;
+    f.glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+    f.glBindVertexArray(vao);
+    f.glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    const GLsizei stride = sizeof(ChunkVertex);
+    f.glEnableVertexAttribArray(ATTR_POS);
+    f.glVertexAttribPointer(ATTR_POS, 3, GL_FLOAT, false, stride, (const GLvoid*) offsetof(ChunkVertex, pos));
+    f.glEnableVertexAttribArray(ATTR_NOR);
+    f.glVertexAttribPointer(ATTR_NOR, 3, GL_FLOAT, false, stride, (const GLvoid*) offsetof(ChunkVertex, nor));
+    f.glEnableVertexAttribArray(ATTR_UV);
+    f.glVertexAttribIPointer(ATTR_UV, 4, GL_UNSIGNED_BYTE, stride, (const GLvoid*) offsetof(ChunkVertex, u));
+    f.glEnableVertexAttribArray(ATTR_SLOT);
+    f.glVertexAttribPointer(ATTR_SLOT, 1, GL_FLOAT, false, stride, (const GLvoid*) offsetof(ChunkVertex, slot));
+    f.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    f.glBindVertexArray(previous);
+}
+
+void ChunkArena::writeOrigin(GLWidget277 &f, int slot)
+{
+    f.glBindBuffer(GL_TEXTURE_BUFFER, origin_buffer);
+    if (origins.size() > origin_capacity) {
+        // Reallocate and upload every origin; the texture keeps pointing at the same buffer
+        while (origin_capacity < origins.size()) {
+            origin_capacity *= 2;
+        }
+        f.glBufferData(GL_TEXTURE_BUFFER, origin_capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+        f.glBufferSubData(GL_TEXTURE_BUFFER, 0, origins.size() * sizeof(glm::vec4), origins.constData());
+        f.glBindTexture(GL_TEXTURE_BUFFER, origin_texture);
+        f.glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, origin_buffer);
+        updateMemory();
+        return;
+    }
+    f.glBufferSubData(GL_TEXTURE_BUFFER, slot * sizeof(glm::vec4), sizeof(glm::vec4), &origins[slot]);
+}
+
+// Counts the storage requested from glBufferData; the driver may round it up
+void ChunkArena::updateMemory()
+{
+    gpu_memory.set((qint64) vertex_capacity * sizeof(ChunkVertex) + (qint64) index_capacity * sizeof(GLuint)
+                   + (qint64) face_capacity * sizeof(GLuint) + (qint64) origin_capacity * sizeof(glm::vec4), 4);
+}
+
+// Takes a free slot, or adds one. Packed meshes need a slot their face records can hold;
+// returns -1 when there is none left
+int ChunkArena::takeSlot(bool packed)
+{
+    for (int i = free_slots.size() - 1; i >= 0; i--) {
+        int slot = free_slots.at(i);
+        if (!packed || slot < MAX_FACE_SLOTS) {
+            free_slots.remove(i);
+            return slot;
+        }
+    }
+    if (packed && allocations.size() >= MAX_FACE_SLOTS) {
+        return -1;
+    }
+    allocations.append(Allocation());
+    origins.append(glm::vec4());
+    return allocations.size() - 1;
+}
+
+int ChunkArena::upload(GLWidget277 &f, MeshData &mesh, const glm::vec3 &origin, float scale)
+{
+    int slot = takeSlot(!mesh.faces.isEmpty());
+    if (slot == -1) {
+        MeshData::unpackFaces(mesh);
+        slot = takeSlot(false);
+    }
+    int vertex_count = mesh.vertices.size();
+    int index_count = mesh.indices.size();
+    int face_count = mesh.faces.size();
+
+    if (largestRange(free_vertices) < vertex_count || largestRange(free_indices) < index_count ||
+            largestRange(free_faces) < face_count) {
+        // Compacting leaves one free range holding all the free space; grow if even that is too small
+        int new_vertex_capacity = vertex_capacity;
+        int new_index_capacity = index_capacity;
+        int new_face_capacity = face_capacity;
+        while (new_vertex_capacity - used_vertices < vertex_count) {
+            new_vertex_capacity *= 2;
+        }
+        while (new_index_capacity - used_indices < index_count) {
+            new_index_capacity *= 2;
+        }
+        while (new_face_capacity - used_faces < face_count) {
+            new_face_capacity *= 2;
+        }
+        compact(f, new_vertex_capacity, new_index_capacity, new_face_capacity);
+    }
+
+    Allocation &a = allocations[slot];
+    a.used = true;
+    a.packed = face_count > 0;
+    a.vertex_count = vertex_count;
+    a.index_count = index_count;
+    a.face_count = face_count;
+    a.part_ends = mesh.part_ends;
+    allocateRange(free_vertices, vertex_count, a.first_vertex);
+    allocateRange(free_indices, index_count, a.first_index);
+    allocateRange(free_faces, face_count, a.first_face);
+    used_vertices += vertex_count;
+    used_indices += index_count;
+    used_faces += face_count;
+
+    for (ChunkVertex &v : mesh.vertices) {
+        v.slot = slot;
+    }
+    Q_ASSERT(face_count == 0 || slot < MAX_FACE_SLOTS);
+    for (quint32 &face : mesh.faces) {
+        face = (face & ((1u << FACE_SLOT_SHIFT) - 1)) | (quint32(slot) << FACE_SLOT_SHIFT);
+    }
+    // Upload through the copy target so the VAO's element buffer binding is left alone
+    if (vertex_count > 0) {
+        f.glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer);
+        f.glBufferSubData(GL_COPY_WRITE_BUFFER, a.first_vertex * sizeof(ChunkVertex),
+                          vertex_count * sizeof(ChunkVertex), mesh.vertices.constData());
+    }
+    if (index_count > 0) {
+        f.glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer);
+        f.glBufferSubData(GL_COPY_WRITE_BUFFER, a.first_index * sizeof(GLuint),
+                          index_count * sizeof(GLuint), mesh.indices.constData());
+    }
+    if (face_count > 0) {
+        f.glBindBuffer(GL_COPY_WRITE_BUFFER, face_buffer);
+        f.glBufferSubData(GL_COPY_WRITE_BUFFER, a.first_face * sizeof(GLuint),
+                          face_count * sizeof(GLuint), mesh.faces.constData());
+    }
+
+    origins[slot] = glm::vec4(origin, scale);
+    writeOrigin(f, slot);
+    return slot;
+}
+
+void ChunkArena::release(int slot)
+{
+    if (slot < 0 || slot >= allocations.size() || !allocations[slot].used) {
+        return;
+    }
+    Allocation &a = allocations[slot];
+    freeRange(free_vertices, a.first_vertex, a.vertex_count);
+    freeRange(free_indices, a.first_index, a.index_count);
+    freeRange(free_faces, a.first_face, a.face_count);
+    used_vertices -= a.vertex_count;
+    used_indices -= a.index_count;
+    used_faces -= a.face_count;
+    a.used = false;
+    free_slots.append(slot);
+}
+
+void ChunkArena::maintain(GLWidget277 &f)
+{
+    // Compact once the biggest hole holds less than half of the free space
+    int free_vertex_count = vertex_capacity - used_vertices;
+    int free_index_count = index_capacity - used_indices;
+    int free_face_count = face_capacity - used_faces;
+    if (largestRange(free_vertices) < free_vertex_count / 2 ||
+            largestRange(free_indices) < free_index_count / 2 ||
+            largestRange(free_faces) < free_face_count / 2) {
+        compact(f, vertex_capacity, index_capacity, face_capacity);
+    }
+}
+
+void ChunkArena::bindVAO(GLWidget277 &f)
+{
+    f.glBindVertexArray(vao);
+}
+
+GLuint ChunkArena::vaoId() const
+{
+    return vao;
+}
+
+void ChunkArena::bindOrigins(GLWidget277 &f, int unit)
+{
+    f.glActiveTexture(GL_TEXTURE0 + unit);
+    f.glBindTexture(GL_TEXTURE_BUFFER, origin_texture);
+    f.glActiveTexture(GL_TEXTURE0);
+}
+
+void ChunkArena::bindFaceVAO(GLWidget277 &f)
+{
+    f.glBindVertexArray(face_vao);
+}
+
+GLuint ChunkArena::faceVaoId() const
+{
+    return face_vao;
+}
+
+void ChunkArena::bindFaces(GLWidget277 &f, int unit)
+{
+    f.glActiveTexture(GL_TEXTURE0 + unit);
+    f.glBindTexture(GL_TEXTURE_BUFFER, face_texture);
+    f.glActiveTexture(GL_TEXTURE0);
+}
+
+// Finds the next run of adjacent parts at or after part whose bits are set in part_mask.
+// Leaves begin/end at its bounds and part on its last part; returns false when there are none left
+bool ChunkArena::nextRun(const QVector<int> &part_ends, int part_mask, int &part, int &begin, int &end)
+{
+    int parts = part_ends.size();
+    for (; part < parts; part++) {
+        if (!(part_mask & (1 << part))) {
+            continue;
+        }
+        begin = part > 0 ? part_ends.at(part - 1) : 0;
+        while (part + 1 < parts && (part_mask & (1 << (part + 1)))) {
+            part++;
+        }
+        end = part_ends.at(part);
+        if (end > begin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ChunkArena::addDraw(int slot, int part_mask, QVector<GLsizei> &counts, QVector<const GLvoid*> &offsets,
+                         QVector<GLint> &base_vertices) const
+{
+    if (slot < 0 || slot >= allocations.size()) {
+        return;
+    }
+    const Allocation &a = allocations.at(slot);
+    if (!a.used || a.packed) {
+        return;
+    }
+    int begin, end;
+    for (int part = 0; nextRun(a.part_ends, part_mask, part, begin, end); part++) {
+        counts.append(end - begin);
+        offsets.append(reinterpret_cast<const GLvoid*>((a.first_index + begin) * sizeof(GLuint)));
+        base_vertices.append(a.first_vertex);
+    }
+}
+
+void ChunkArena::addFaceDraw(int slot, int part_mask, QVector<GLint> &firsts, QVector<GLsizei> &counts) const
+{
+    if (slot < 0 || slot >= allocations.size()) {
+        return;
+    }
+    const Allocation &a = allocations.at(slot);
+    if (!a.used || !a.packed) {
+        return;
+    }
+    int begin, end;
+    for (int part = 0; nextRun(a.part_ends, part_mask, part, begin, end); part++) {
+        firsts.append((a.first_face + begin) * 6);
+        counts.append((end - begin) * 6);
+    }
+}
+
+int ChunkArena::usedVertices() const
+{
+    return used_vertices;
+}
+
+int ChunkArena::vertexCapacity() const
+{
+    return vertex_capacity;
+}
+
+int ChunkArena::usedFaces() const
+{
+    return used_faces;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <openGL/glwidget277.h>
+#include <openGL/drawable.h>
+#include <la.h>
+#include <memorystats.h>
+#include <scene/meshdata.h>
+
+#include <QVector>
+#include <QMap>
+
+// One large vertex buffer, index buffer and face buffer that every chunk mesh is suballocated
+// from, so all visible chunks can be drawn with a single multi-draw call. Meshes are stored
+// relative to their chunk; the chunk's origin is looked up by the vertex shader in a buffer
+// texture indexed by the slot stored with each vertex or face.
+class ChunkArena
+{
+public:
+    ChunkArena();
+
+    void create(GLWidget277 &f);
+    void destroy(GLWidget277 &f);
+
+    // Copies a mesh into the arena and returns the slot that now owns it.
+    // The arena grows (and is compacted) when there is no free range large enough. Packed faces
+    // only have room for the first MAX_FACE_SLOTS slots; once those are taken, packed meshes
+    // are unpacked and stored indexed instead.
+    int upload(GLWidget277 &f, MeshData &mesh, const glm::vec3 &origin, float scale = 1.f);
+    // Frees a slot's ranges. Needs no GL context, so chunks can release from their destructor
+    void release(int slot);
+    // Repacks every mesh to the front of new buffers when the free space is too scattered
+    void maintain(GLWidget277 &f);
+
+    // Binds the VAO holding the arena's vertex layout and index buffer
+    void bindVAO(GLWidget277 &f);
+    GLuint vaoId() const;
+    // Binds the chunk origin buffer texture to texture unit unit
+    void bindOrigins(GLWidget277 &f, int unit);
+    // Binds the attribute-less VAO that packed faces are drawn with
+    void bindFaceVAO(GLWidget277 &f);
+    GLuint faceVaoId() const;
+    // Binds the packed face buffer texture to texture unit unit
+    void bindFaces(GLWidget277 &f, int unit);
+    // Appends the draw parameters of the parts of slot's mesh whose bits are set in part_mask to
+    // the arrays passed to glMultiDrawElementsBaseVertex. Adjacent parts share one draw.
+    // Slots holding packed faces are skipped.
+    void addDraw(int slot, int part_mask, QVector<GLsizei> &counts, QVector<const GLvoid*> &offsets,
+                 QVector<GLint> &base_vertices) const;
+    // Like addDraw for slots holding packed faces, for glMultiDrawArrays with six vertices per face
+    void addFaceDraw(int slot, int part_mask, QVector<GLint> &firsts, QVector<GLsizei> &counts) const;
+
+    int usedVertices() const;
+    int vertexCapacity() const;
+    int usedFaces() const;
+
+private:
+    struct Allocation {
+        bool used;
+        bool packed;    // holds faces instead of vertices and indices
+        int first_vertex, vertex_count;
+        int first_index, index_count;
+        int first_face, face_count;
+        QVector<int> part_ends;     // relative to first_index, or first_face when packed
+    };
+
+    GLuint vao, face_vao;
+    GLuint vertex_buffer, index_buffer;
+    GLuint face_buffer, face_texture;
+    GLuint origin_buffer, origin_texture;
+    int vertex_capacity, index_capacity, face_capacity, origin_capacity;
+    int used_vertices, used_indices, used_faces;
+    MemoryGauge gpu_memory;     // storage of the four buffers
+
+    QVector<Allocation> allocations;    // indexed by slot
+    QVector<int> free_slots;
+    QVector<glm::vec4> origins;         // xyz = chunk origin, w = scale; mirrors origin_buffer
+    QMap<int, int> free_vertices;       // offset -> length of each free range
+    QMap<int, int> free_indices;
+    QMap<int, int> free_faces;
+
+    static bool allocateRange(QMap<int, int> &free_list, int length, int &offset);
+    static void freeRange(QMap<int, int> &free_list, int offset, int length);
+    static int largestRange(const QMap<int, int> &free_list);
+    int takeSlot(bool packed);
+    static bool nextRun(const QVector<int> &part_ends, int part_mask, int &part, int &begin, int &end);
+    void compact(GLWidget277 &f, int new_vertex_capacity, int new_index_capacity, int new_face_capacity);
+    GLuint repack(GLWidget277 &f, GLuint old_buffer, int capacity, int element_size,
+                  int Allocation::*first, int Allocation::*count);
+    void writeOrigin(GLWidget277 &f, int slot);
+    void updateMemory();
+    void setupVAO(GLWidget277 &f);
+};
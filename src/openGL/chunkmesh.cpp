@@ -0,0 +1,197 @@
+#include "chunkmesh.h"
+#include <profiler.h>
+#include <trace.h>
+#include <jobs.h>
+#include <mpscqueue.h>
+
+bool ChunkMesh::pack_faces = false;
+
+namespace {
+
+// A full detail mesh built by a job, on its way to the render thread
+struct MeshBuild {
+    ChunkData *chunk;
+    int revision;   // of the cells it was built from
+    MeshData mesh;
+    qint64 nsecs = 0;   // the job spent meshing, added to PHASE_MESH_JOBS when collected
+    MemoryGauge memory{MEM_CHUNK_MESHES};
+};
+
+// Filled by mesh jobs, drained by ChunkMesh::collect
+MpscQueue<MeshBuild*> built;
+
+}
+
+ChunkMesh::ChunkMesh(ChunkData &chunk)
+    : chunk(chunk), lod_stale(true), gl(nullptr), arena(nullptr), lod_slots{-1, -1, -1, -1}
+{}
+
+ChunkMesh::~ChunkMesh()
+{
+    if (lod_build) {
+        lod_build->owner = nullptr;
+    }
+    if (arena) {
+        for (int slot : lod_slots) {
+            arena->release(slot);
+        }
+    }
+}
+
+ChunkMesh* ChunkMesh::of(ChunkData &chunk)
+{
+    // The only render data chunks are given is a ChunkMesh
+    if (!chunk.render) {
+        chunk.render = new ChunkMesh(chunk);
+    }
+    return static_cast<ChunkMesh*>(chunk.render);
+}
+
+void ChunkMesh::build(const CellGrid &grid, bool packed, MeshData &mesh)
+{
+    if (packed) {
+        MeshData::buildFaces(grid, mesh);
+    } else {
+        MeshData::buildVertices(grid, mesh);
+    }
+}
+
+// The chunk has just become MESHING. The job meshes an implicitly shared copy of the cells, so
+// edits made meanwhile detach from it instead of tearing the mesh
+void ChunkMesh::startMesh()
+{
+    MeshBuild *result = new MeshBuild();
+    result->chunk = &chunk;
+    result->revision = chunk.revision;
+    CellGrid copy = chunk.cells;
+    bool packed = pack_faces;
+    JobSystem::submit(JobSystem::create([result, copy, packed]() {
+        ChunkData *chunk = result->chunk;
+        TraceScope trace("mesh", "chunk", chunk->cell.x, chunk->cell.y, chunk->cell.z);
+        QElapsedTimer clock;
+        clock.start();
+        build(copy, packed, result->mesh);
+        result->nsecs = clock.nsecsElapsed();
+        result->memory.set(result->mesh.bytes(), 1);
+        // Fails if the chunk was evicted; collect frees it either way. Once the build is
+        // queued the render thread may free the chunk, so it isn't touched after
+        chunk->transition(CHUNK_MESHING, CHUNK_AWAITING_UPLOAD);
+        built.push(result);
+    }));
+}
+
+void ChunkMesh::uploadMesh(GLWidget277 &f, ChunkArena &arena, const glm::vec3 &origin, MeshData &mesh)
+{
+    this->gl = &f;
+    this->arena = &arena;
+    uploadLevel(f, arena, 0, origin, mesh);
+    // The coarse meshes are rebuilt the next time one of them is needed
+    lod_stale = true;
+    chunk.transition(CHUNK_AWAITING_UPLOAD, CHUNK_READY);
+}
+
+void ChunkMesh::uploadLevel(GLWidget277 &f, ChunkArena &arena, int level, const glm::vec3 &origin, MeshData &level_mesh)
+{
+    ProfileScope scope(PHASE_UPLOAD);
+    TraceScope trace("upload", "chunk", chunk.cell.x, chunk.cell.y, chunk.cell.z);
+    arena.release(lod_slots[level]);
+    lod_slots[level] = arena.upload(f, level_mesh, origin, 1 << level);
+    level_mesh = MeshData();
+}
+
+bool ChunkMesh::building() const
+{
+    ChunkState state = chunk.state();
+    return !lod_build.isNull() || state == CHUNK_MESHING || state == CHUNK_AWAITING_UPLOAD;
+}
+
+void ChunkMesh::remesh(const QVector<ChunkMesh*> &meshes)
+{
+    ProfileScope scope(PHASE_MESH_SUBMIT);
+    for (ChunkMesh *mesh : meshes) {
+        if (mesh->chunk.transition(CHUNK_DIRTY, CHUNK_MESHING)) {
+            mesh->startMesh();
+        }
+    }
+}
+
+void ChunkMesh::collect(GLWidget277 &f, ChunkArena &arena)
+{
+    ProfileScope scope(PHASE_UPLOAD);
+    MeshBuild *result;
+    while (built.pop(result)) {
+        Profiler::add(PHASE_MESH_JOBS, result->nsecs);
+        ChunkData *chunk = result->chunk;
+        if (chunk->state() == CHUNK_EVICTING) {
+            delete chunk;
+        } else if (result->revision != chunk->revision) {
+            // Edited while the job ran; the next remesh starts over from the new cells
+            chunk->transition(CHUNK_AWAITING_UPLOAD, CHUNK_DIRTY);
+        } else {
+            of(*chunk)->uploadMesh(f, arena, glm::vec3(chunk->cell) * 16.f, result->mesh);
+        }
+        delete result;
+    }
+}
+
+// Called through the main thread queue once the coarse meshes are built
+void ChunkMesh::finishLevels(LodMeshes *result)
+{
+    Profiler::add(PHASE_MESH_JOBS, result->nsecs);
+    if (lod_build.data() != result) {
+        return;
+    }
+    for (int l = 1; l < LOD_LEVELS; l++) {
+        uploadLevel(*gl, *arena, l, glm::vec3(chunk.cell) * 16.f, result->meshes[l]);
+    }
+    lod_build.reset();
+}
+
+int ChunkMesh::prepare(GLWidget277 &f, ChunkArena &arena, const glm::vec3 &origin, int level)
+{
+    this->gl = &f;
+    this->arena = &arena;
+    if (level == 0) {
+        return lod_slots[0];
+    }
+
+    if (!lod_build && lod_stale) {
+        // The job gets its own copy of the cells (a cheap implicitly shared copy) and writes
+        // into a shared result, so neither edits nor deleting the chunk affect it
+        CellGrid copy = chunk.cells;
+        QSharedPointer<LodMeshes> result(new LodMeshes());
+        result->owner = this;
+        bool packed = pack_faces;
+        glm::ivec3 at = chunk.cell;
+        lod_build = result;
+        JobSystem::submit(JobSystem::create([copy, result, packed, at]() {
+            TraceScope trace("mesh lod", "chunk", at.x, at.y, at.z);
+            QElapsedTimer clock;
+            clock.start();
+            CellGrid grid = copy;
+            qint64 bytes = 0;
+            for (int l = 1; l < LOD_LEVELS; l++) {
+                grid = ChunkData::downsample(grid);
+                build(grid, packed, result->meshes[l]);
+                bytes += result->meshes[l].bytes();
+            }
+            result->memory.set(bytes, LOD_LEVELS - 1);
+            result->nsecs = clock.nsecsElapsed();
+            // Uploading needs the context, so the meshes go back to the main thread
+            JobSystem::runOnMainThread([result]() {
+                if (result->owner) {
+                    result->owner->finishLevels(result.data());
+                }
+            });
+        }));
+        lod_stale = false;
+    }
+
+    // Until the requested level is ready, draw the closest finer one
+    for (int l = level; l > 0; l--) {
+        if (lod_slots[l] != -1) {
+            return lod_slots[l];
+        }
+    }
+    return lod_slots[0];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <openGL/chunkarena.h>
+#include <scene/chunkdata.h>
+#include <scene/meshdata.h>
+#include <memorystats.h>
+#include <QSharedPointer>
+
+struct LodMeshes;
+
+// How a ChunkData is drawn: the ChunkArena slots holding its meshes at each level of detail.
+// Attached to the chunk as its render data the first time it is drawn. Meshes are built by
+// jobs from a copy of the cells and come back to the render thread through a lock-free queue,
+// following the chunk's ChunkState.
+class ChunkMesh : public ChunkRenderData
+{
+public:
+    // Level l is meshed from the cells downsampled 2^l times in each direction
+    static const int LOD_LEVELS = 4;
+    // Mesh as packed face records drawn by vertex pulling instead of indexed vertices.
+    // Takes effect for meshes built after it changes
+    static bool pack_faces;
+
+    // The chunk's mesh, attached on first use
+    static ChunkMesh* of(ChunkData &chunk);
+    ~ChunkMesh();
+
+    // Returns the arena slot to draw at the given level of detail, -1 until remesh and collect
+    // have brought in the first mesh. Starts meshing the coarse levels as a job when they are
+    // missing or stale; the job hands them back through the main thread queue, and until they
+    // arrive the closest finer level is returned.
+    int prepare(GLWidget277 &f, ChunkArena &arena, const glm::vec3 &origin, int level);
+    // True while meshes are being built or wait to be uploaded
+    bool building() const;
+    // Starts a mesh job for every DIRTY chunk among the given ones, without waiting for them
+    static void remesh(const QVector<ChunkMesh*> &meshes);
+    // Uploads the meshes jobs finished since the last call, drops those the chunk changed
+    // under, and frees chunks evicted while their mesh was in flight. Render thread only
+    static void collect(GLWidget277 &f, ChunkArena &arena);
+
+private:
+    explicit ChunkMesh(ChunkData &chunk);
+
+    ChunkData &chunk;
+    bool lod_stale;                         // the coarse meshes don't match the cells
+    QSharedPointer<LodMeshes> lod_build;    // coarse meshes being built, null when idle
+    // Where meshes were last uploaded; coarse meshes go there when they arrive
+    GLWidget277* gl;
+    ChunkArena* arena;
+    int lod_slots[LOD_LEVELS];              // arena slot per level, -1 if not uploaded
+
+    void startMesh();
+    void uploadMesh(GLWidget277 &f, ChunkArena &arena, const glm::vec3 &origin, MeshData &mesh);
+    void finishLevels(LodMeshes *result);
+    void uploadLevel(GLWidget277 &f, ChunkArena &arena, int level, const glm::vec3 &origin, MeshData &level_mesh);
+    static void build(const CellGrid &grid, bool packed, MeshData &mesh);
+};
+
+// Output of a background level of detail build; index 0 is unused
+struct LodMeshes {
+    ChunkMesh *owner;   // cleared when the mesh is destroyed first; only used on the main thread
+    MeshData meshes[ChunkMesh::LOD_LEVELS];
+    MemoryGauge memory{MEM_CHUNK_MESHES};
+    qint64 nsecs = 0;   // the job spent meshing, added to PHASE_MESH_JOBS when it arrives
+};
@@ -1,4 +1,5 @@
 #include <openGL/drawable.h>
+#include <QOpenGLContext>
 
 Drawable::Drawable()
     : bufIdx(QOpenGLBuffer::IndexBuffer),
@@ -26,6 +27,7 @@ void Drawable::destroy()
     bufNor.destroy();
     bufCol.destroy();
     bufUV.destroy();
+    vao.destroy();
 }
 
 GLenum Drawable::drawMode(){return GL_TRIANGLES;}
@@ -35,3 +37,45 @@ bool Drawable::bindPos(){return bufPos.bind();}
 bool Drawable::bindNor(){return bufNor.bind();}
 bool Drawable::bindCol(){return bufCol.bind();}
 bool Drawable::bindUV(){return bufUV.bind();}
+
+void Drawable::bindVAO()
+{
+    vao.bind();
+}
+
+void Drawable::beginVAO()
+{
+    QOpenGLFunctions_3_2_Core *f = QOpenGLContext::currentContext()->versionFunctions<QOpenGLFunctions_3_2_Core>();
+    f->glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+    vao.create();
+    vao.bind();
+}
+
+void Drawable::endVAO()
+{
+    QOpenGLFunctions_3_2_Core *f = QOpenGLContext::currentContext()->versionFunctions<QOpenGLFunctions_3_2_Core>();
+    if (bufPos.isCreated() && bindPos()) {
+        f->glEnableVertexAttribArray(ATTR_POS);
+        f->glVertexAttribPointer(ATTR_POS, 3, GL_FLOAT, false, 0, NULL);
+    }
+    if (bufNor.isCreated() && bindNor()) {
+        f->glEnableVertexAttribArray(ATTR_NOR);
+        f->glVertexAttribPointer(ATTR_NOR, 3, GL_FLOAT, false, 0, NULL);
+    }
+    if (bufCol.isCreated() && bindCol()) {
+        f->glEnableVertexAttribArray(ATTR_COL);
+        f->glVertexAttribPointer(ATTR_COL, 3, GL_FLOAT, false, 0, NULL);
+    }
+    if (bufUV.isCreated() && bindUV()) {
+        f->glEnableVertexAttribArray(ATTR_UV);
+        f->glVertexAttribPointer(ATTR_UV, 4, GL_FLOAT, false, 0, NULL);
+    }
+    // The element buffer binding is part of the VAO too
+    bindIdx();
+    f->glBindVertexArray(previous_vao);
+}
+
+GLuint Drawable::vaoId() const
+{
+    return vao.objectId();
+}
@@ -6,6 +6,12 @@
 #include <QOpenGLFunctions_3_2_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+
+// Attribute locations every ShaderProgram binds its inputs to, so one VAO works with any program
+enum VertexAttribute {
+    ATTR_POS = 0, ATTR_NOR, ATTR_COL, ATTR_UV, ATTR_SLOT
+};
 
 // This defines an abstract class which can be rendered by our shader program.
 // Make any geometry a subclass of Drawable in order to render it with the ShaderProgram class.
@@ -28,8 +34,16 @@ public:
     bool bindNor();
     bool bindCol();
     bool bindUV();
+    void bindVAO();
+    GLuint vaoId() const;
 
 protected:
+    // Bracket the buffer uploads in create(): beginVAO binds this Drawable's own VAO so the
+    // index buffer attaches to it, and endVAO records the attribute layout and restores the
+    // VAO that was bound before
+    void beginVAO();
+    void endVAO();
+
     int count;
     //The vertex buffer objects every object needs to be drawn.
     //If you create your own Drawable subclasses, you can add more VBO types in that class's header file.
@@ -38,4 +52,6 @@ protected:
     QOpenGLBuffer bufNor;
     QOpenGLBuffer bufCol;
     QOpenGLBuffer bufUV;
+    QOpenGLVertexArrayObject vao;
+    GLint previous_vao = 0;
 };
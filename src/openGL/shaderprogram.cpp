@@ -1,63 +1,146 @@
 #include "shaderprogram.h"
+#include <scene/blocks.h>
 #include <la.h>
 
 
+GLuint ShaderProgram::current_program = 0;
+GLuint ShaderProgram::current_texture = 0;
+GLuint ShaderProgram::current_vao = 0;
+qint64 ShaderProgram::triangles = 0;
+
+ShaderProgram::ShaderProgram()
+    : textSampler(nullptr), model_set(false), viewproj_set(false), time(-1.f), origins_set(false), faces_set(false)
+{}
+
 void ShaderProgram::create(const char *vertfile, const char *fragfile)
 {
     prog.addShaderFromSourceFile(QOpenGLShader::Vertex  , vertfile);
     prog.addShaderFromSourceFile(QOpenGLShader::Fragment, fragfile);
+    // Fixed locations let every Drawable's VAO be shared between programs
+    prog.bindAttributeLocation("vs_Pos", ATTR_POS);
+    prog.bindAttributeLocation("vs_Nor", ATTR_NOR);
+    prog.bindAttributeLocation("vs_Col", ATTR_COL);
+    prog.bindAttributeLocation("vs_uv", ATTR_UV);
+    prog.bindAttributeLocation("vs_Tile", ATTR_UV);
+    prog.bindAttributeLocation("vs_Slot", ATTR_SLOT);
     prog.link();
 
     attrPos = prog.attributeLocation("vs_Pos");
     attrNor = prog.attributeLocation("vs_Nor");
     attrCol = prog.attributeLocation("vs_Col");
     attrUV = prog.attributeLocation("vs_uv");
+    attrSlot = prog.attributeLocation("vs_Slot");
     unifModel      = prog.uniformLocation("u_Model");
     unifModelInvTr = prog.uniformLocation("u_ModelInvTr");
     unifViewProj   = prog.uniformLocation("u_ViewProj");
     //equivalent to GLint unifUV = glGetUniformLocation(program, "myTexture");
     unifUV = prog.uniformLocation("myTexture");
-    unifTime = prog.uniformLocation("timer");
+    unifTiles = prog.uniformLocation("u_Tiles");
+    unifTime = prog.uniformLocation("u_Time");
+    unifChunkOrigins = prog.uniformLocation("u_ChunkOrigins");
+    unifChunkFaces = prog.uniformLocation("u_ChunkFaces");
+
+    // Shaders that unpack block types get the registry's tables
+    int unifBlockTiles = prog.uniformLocation("u_BlockTiles");
+    int unifBlockFlags = prog.uniformLocation("u_BlockFlags");
+    if (unifBlockTiles != -1) {
+        static_assert(BLOCK_TYPES <= MAX_FACE_BLOCKS, "packed faces have no room for more block types");
+        GLint tiles[BLOCK_TYPES * 6];
+        GLint flags[BLOCK_TYPES];
+        for (int b = 0; b < BLOCK_TYPES; b++) {
+            for (int face = 0; face < 6; face++) {
+                tiles[b * 6 + face] = BLOCKS[b].tiles[face];
+            }
+            flags[b] = BLOCKS[b].flags;
+        }
+        use();
+        prog.setUniformValueArray(unifBlockTiles, tiles, BLOCK_TYPES * 6);
+        prog.setUniformValueArray(unifBlockFlags, flags, BLOCK_TYPES);
+    }
+}
+
+void ShaderProgram::resetStateCache()
+{
+    current_program = 0;
+    current_texture = 0;
+    current_vao = 0;
+}
+
+qint64 ShaderProgram::trianglesDrawn()
+{
+    return triangles;
+}
+
+void ShaderProgram::resetTriangleCount()
+{
+    triangles = 0;
+}
 
+void ShaderProgram::use()
+{
+    if (current_program != prog.programId()) {
+        prog.bind();
+        current_program = prog.programId();
+    }
+}
+
+void ShaderProgram::bindTexture()
+{
+    if (textSampler != nullptr && current_texture != textSampler->textureId()) {
+        textSampler->bind(0);
+        current_texture = textSampler->textureId();
+    }
 }
 
 void ShaderProgram::setModelMatrix(const glm::mat4 &model)
 {
-    prog.bind();
+    // Skips the upload and the CPU inverse when the matrix hasn't changed
+    if (model_set && model == this->model) {
+        return;
+    }
+    this->model = model;
+    model_set = true;
+    use();
 
     if (unifModel != -1) {
         prog.setUniformValue(unifModel, la::to_qmat(model));
     }
 
     if (unifModelInvTr != -1) {
-        glm::mat4 modelinvtr = glm::transpose(model);
-        modelinvtr = glm::inverse(glm::transpose(model));
+        glm::mat4 modelinvtr = glm::inverse(glm::transpose(model));
         prog.setUniformValue(unifModelInvTr, la::to_qmat(modelinvtr));
     }
 }
 
 void ShaderProgram::setViewProjMatrix(const glm::mat4& vp)
 {
-    prog.bind();
+    if (viewproj_set && vp == viewproj) {
+        return;
+    }
+    viewproj = vp;
+    viewproj_set = true;
+    use();
 
     if(unifViewProj != -1){
         prog.setUniformValue(unifViewProj, la::to_qmat(vp));
     }
 }
 
-void ShaderProgram::setTimer(int time) {
-    prog.bind();
-
+void ShaderProgram::setTime(float seconds) {
+    if (seconds == time) {
+        return;
+    }
+    time = seconds;
     if (unifTime != -1) {
-        GLint timer = time;
-        prog.setUniformValue(unifTime, timer);
+        use();
+        prog.setUniformValue(unifTime, seconds);
     }
 }
 
 //set unifUV thing
 void ShaderProgram::setUVImage(QOpenGLTexture* texture) {
     //equivalent to calling glUseProgram
-    prog.bind();
+    use();
 
     textSampler = texture;
     if (unifUV != -1) {
@@ -69,7 +152,7 @@ void ShaderProgram::setUVImage(QOpenGLTexture* texture) {
         textSampler->setMinificationFilter(QOpenGLTexture::Nearest);
         textSampler->setMagnificationFilter(QOpenGLTexture::Nearest);
         textSampler->bind(0);
-        GLuint ID = textSampler->textureId();
+        current_texture = textSampler->textureId();
 
         prog.setUniformValue(unifUV, 0);
 
@@ -77,50 +160,116 @@ void ShaderProgram::setUVImage(QOpenGLTexture* texture) {
     }
 }
 
+void ShaderProgram::setTileArray(QOpenGLTexture* texture)
+{
+    use();
+
+    textSampler = texture;
+    if (unifTiles != -1) {
+        prog.setUniformValue(unifTiles, 0);
+    }
+}
+
 // This function, as its name implies, uses the passed in GL widget
+// The Drawable's VAO holds its whole vertex layout, so drawing is just binding it
 void ShaderProgram::draw(GLWidget277 &f, Drawable &d)
 {
-    prog.bind();
+    use();
 
-    // Each of the following blocks checks that:
-    //   * This shader has this attribute, and
-    //   * This Drawable has a vertex buffer for this attribute.
-    // If so, it binds the appropriate buffers to each attribute.
+    if (current_vao != d.vaoId()) {
+        d.bindVAO();
+        current_vao = d.vaoId();
+    }
+    bindTexture();
 
-    if (attrPos != -1 && d.bindPos()) {
-        prog.enableAttributeArray(attrPos);
-        f.glVertexAttribPointer(attrPos, 3, GL_FLOAT, false, 0, NULL);
+    // This invokes the shader program, which accesses the vertex buffers.
+    f.glDrawElements(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0);
+    if (d.drawMode() == GL_TRIANGLES) {
+        triangles += d.elemCount() / 3;
     }
 
-    if (attrNor != -1 && d.bindNor()) {
-        prog.enableAttributeArray(attrNor);
-        f.glVertexAttribPointer(attrNor, 3, GL_FLOAT, false, 0, NULL);
+    f.printGLErrorLog();
+}
+
+int ShaderProgram::draw(GLWidget277 &f, ChunkArena &arena, const QVector<int> &arena_slots,
+                        const QVector<int> &part_masks)
+{
+    QVector<GLsizei> counts;
+    QVector<const GLvoid*> offsets;
+    QVector<GLint> base_vertices;
+    for (int i = 0; i < arena_slots.size(); i++) {
+        arena.addDraw(arena_slots[i], part_masks[i], counts, offsets, base_vertices);
+    }
+    if (counts.isEmpty()) {
+        return 0;
     }
 
-    if (attrCol != -1 && d.bindCol()) {
-        prog.enableAttributeArray(attrCol);
-        f.glVertexAttribPointer(attrCol, 3, GL_FLOAT, false, 0, NULL);
+    use();
+
+    if (current_vao != arena.vaoId()) {
+        arena.bindVAO(f);
+        current_vao = arena.vaoId();
     }
+    bindArenaTextures(f, arena);
+    bindTexture();
 
-    //ADDED UV STUFF
-    if (attrUV != -1 && d.bindUV()) {
-        prog.enableAttributeArray(attrUV);
-        f.glVertexAttribPointer(attrUV, 4, GL_FLOAT, false, 0, NULL);
+    f.glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.constData(), GL_UNSIGNED_INT, offsets.constData(),
+                                    counts.size(), base_vertices.data());
+    for (GLsizei count : counts) {
+        triangles += count / 3;
     }
 
-    // Bind the index buffer and then draw shapes from it.
-    // This invokes the shader program, which accesses the vertex buffers.
-    d.bindIdx();
-    if(textSampler != nullptr)
-    {
-        textSampler->bind();
+    f.printGLErrorLog();
+    return counts.size();
+}
+
+/**
+ * @brief ShaderProgram::drawFaces - draws packed faces by vertex pulling
+ * Every face is six vertices with no attributes; chunkface.vert.glsl finds its face record in
+ * u_ChunkFaces at gl_VertexID / 6 and builds the corner from it, so no index buffer is needed.
+ */
+int ShaderProgram::drawFaces(GLWidget277 &f, ChunkArena &arena, const QVector<int> &arena_slots,
+                             const QVector<int> &part_masks)
+{
+    QVector<GLint> firsts;
+    QVector<GLsizei> counts;
+    for (int i = 0; i < arena_slots.size(); i++) {
+        arena.addFaceDraw(arena_slots[i], part_masks[i], firsts, counts);
     }
-    f.glDrawElements(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0);
+    if (counts.isEmpty()) {
+        return 0;
+    }
+
+    use();
+
+    if (current_vao != arena.faceVaoId()) {
+        arena.bindFaceVAO(f);
+        current_vao = arena.faceVaoId();
+    }
+    bindArenaTextures(f, arena);
+    bindTexture();
 
-    if (attrPos != -1) prog.disableAttributeArray(attrPos);
-    if (attrNor != -1) prog.disableAttributeArray(attrNor);
-    if (attrCol!= -1) prog.disableAttributeArray(attrCol);
-    if (attrUV != -1) prog.disableAttributeArray(attrUV);
+    f.glMultiDrawArrays(GL_TRIANGLES, firsts.constData(), counts.constData(), counts.size());
+    for (GLsizei count : counts) {
+        triangles += count / 3;
+    }
 
     f.printGLErrorLog();
+    return counts.size();
+}
+
+void ShaderProgram::bindArenaTextures(GLWidget277 &f, ChunkArena &arena)
+{
+    arena.bindOrigins(f, 1);
+    if (unifChunkOrigins != -1 && !origins_set) {
+        prog.setUniformValue(unifChunkOrigins, 1);
+        origins_set = true;
+    }
+    if (unifChunkFaces != -1) {
+        arena.bindFaces(f, 2);
+        if (!faces_set) {
+            prog.setUniformValue(unifChunkFaces, 2);
+            faces_set = true;
+        }
+    }
 }
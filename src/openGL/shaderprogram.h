@@ -1,6 +1,7 @@
 #pragma once
 
 #include <openGL/drawable.h>
+#include <openGL/chunkarena.h>
 #include <openGL/glwidget277.h>
 #include <la.h>
 
@@ -20,21 +21,59 @@ public:
     int attrNor;
     int attrCol;
     int attrUV;
+    int attrSlot;
 
     int unifModel;
     int unifModelInvTr;
     int unifViewProj;
     int unifColor;
     int unifUV;
+    int unifTiles;
     int unifTime;
+    int unifChunkOrigins;
+    int unifChunkFaces;
 
     QOpenGLTexture* textSampler;
 
 public:
+    ShaderProgram();
     void create(const char *vertfile, const char *fragfile);
     void setModelMatrix(const glm::mat4 &model);
     void setViewProjMatrix(const glm::mat4& vp);
     void setUVImage(QOpenGLTexture* texture);
-    void setTimer(int time);
+    // Samples the block tiles from a TileArray texture; leaves its filtering alone
+    void setTileArray(QOpenGLTexture* texture);
+    // Seconds since the widget started; animated textures are offset from it on the GPU
+    void setTime(float seconds);
     void draw(GLWidget277 &f, Drawable &d);
+    // Draws the given arena slots with one glMultiDrawElementsBaseVertex call, each limited to
+    // the mesh parts set in the matching entry of part_masks. Returns the number of ranges drawn
+    int draw(GLWidget277 &f, ChunkArena &arena, const QVector<int> &arena_slots, const QVector<int> &part_masks);
+    // Same for slots holding packed faces, with one glMultiDrawArrays call and no vertex attributes
+    int drawFaces(GLWidget277 &f, ChunkArena &arena, const QVector<int> &arena_slots, const QVector<int> &part_masks);
+
+    // Forgets which program, texture and VAO are bound, e.g. when Qt may have changed them
+    static void resetStateCache();
+    // Triangles submitted by every program since the last resetTriangleCount
+    static qint64 trianglesDrawn();
+    static void resetTriangleCount();
+
+private:
+    // Binds the program only if it is not already current
+    void use();
+    void bindTexture();
+    // Binds the arena's buffer textures and points the samplers at them
+    void bindArenaTextures(GLWidget277 &f, ChunkArena &arena);
+
+    // Bindings shared by every program, so redundant binds can be skipped
+    static GLuint current_program;
+    static GLuint current_texture;
+    static GLuint current_vao;
+    static qint64 triangles;
+
+    // Last values uploaded to this program's uniforms
+    glm::mat4 model, viewproj;
+    bool model_set, viewproj_set;
+    float time;
+    bool origins_set, faces_set;
 };
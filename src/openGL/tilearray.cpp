@@ -0,0 +1,32 @@
+#include "tilearray.h"
+
+const int TileArray::TILES_PER_SIDE;
+
+QOpenGLTexture* TileArray::create(const QImage &atlas)
+{
+    QImage image = atlas.convertToFormat(QImage::Format_RGBA8888);
+    int tile_width = image.width() / TILES_PER_SIDE;
+    int tile_height = image.height() / TILES_PER_SIDE;
+
+    QOpenGLTexture* tiles = new QOpenGLTexture(QOpenGLTexture::Target2DArray);
+    tiles->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    tiles->setSize(tile_width, tile_height);
+    tiles->setLayers(TILES_PER_SIDE * TILES_PER_SIDE);
+    tiles->setMipLevels(tiles->maximumMipLevels());
+    tiles->allocateStorage();
+
+    for (int row = 0; row < TILES_PER_SIDE; row++) {
+        for (int col = 0; col < TILES_PER_SIDE; col++) {
+            QImage tile = image.copy(col * tile_width, row * tile_height, tile_width, tile_height);
+            tiles->setData(0, layer(col, row), QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, tile.constBits());
+        }
+    }
+    tiles->generateMipMaps();
+
+    // Magnified tiles keep their hard pixel edges; minified ones blend between mip levels.
+    // Animated tiles scroll into the next layer in the shader, so nothing wraps
+    tiles->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
+    tiles->setMagnificationFilter(QOpenGLTexture::Nearest);
+    tiles->setWrapMode(QOpenGLTexture::ClampToEdge);
+    return tiles;
+}
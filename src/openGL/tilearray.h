@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QOpenGLTexture>
+#include <QImage>
+
+// The block atlas split into a GL_TEXTURE_2D_ARRAY with one layer per tile. Every tile gets
+// its own mip chain, so distant faces read small mips instead of the full-resolution atlas,
+// and no mip level blends a tile with its neighbours in the atlas.
+class TileArray
+{
+public:
+    static const int TILES_PER_SIDE = 16;
+
+    // Layer holding the atlas tile in column col, row row (row 0 at the top of the image)
+    static int layer(int col, int row) { return row * TILES_PER_SIDE + col; }
+
+    // Uploads each tile of atlas to its own layer and builds the mipmaps
+    static QOpenGLTexture* create(const QImage &atlas);
+};
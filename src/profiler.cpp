@@ -0,0 +1,103 @@
+#include "profiler.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+const int Profiler::WINDOW;
+qint64 Profiler::current[PROFILE_PHASES] = {};
+qint64 Profiler::history[WINDOW][PROFILE_PHASES] = {};
+int Profiler::frames = 0;
+ProfileScope *ProfileScope::innermost = nullptr;
+
+static const char *PHASE_NAMES[PROFILE_PHASES] = {
+    "generate", "mesh submit", "mesh jobs", "upload", "physics", "cull", "far field", "draw", "gpu terrain"
+};
+
+const char* Profiler::phaseName(ProfilePhase phase)
+{
+    return PHASE_NAMES[phase];
+}
+
+void Profiler::add(ProfilePhase phase, qint64 nsecs)
+{
+    current[phase] += nsecs;
+}
+
+void Profiler::endFrame()
+{
+    qint64 *row = history[frames % WINDOW];
+    std::copy(current, current + PROFILE_PHASES, row);
+    std::fill(current, current + PROFILE_PHASES, 0);
+    frames++;
+}
+
+double Profiler::mean(ProfilePhase phase)
+{
+    int n = std::min(frames, WINDOW);
+    if (n == 0) {
+        return 0;
+    }
+    qint64 total = 0;
+    for (int i = 0; i < n; i++) {
+        total += history[i][phase];
+    }
+    return total / 1e6 / n;
+}
+
+double Profiler::max(ProfilePhase phase)
+{
+    qint64 longest = 0;
+    for (int i = 0; i < std::min(frames, WINDOW); i++) {
+        longest = std::max(longest, history[i][phase]);
+    }
+    return longest / 1e6;
+}
+
+/**
+ * @brief Profiler::dump - writes the window's statistics, then one line per frame in it
+ * Frame lines are oldest first and hold each phase's milliseconds, in ProfilePhase order.
+ */
+bool Profiler::dump(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    int n = std::min(frames, WINDOW);
+    out << "# " << n << " frames, milliseconds per frame\n";
+    out << "# phase, mean, max\n";
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        out << phaseName((ProfilePhase) p) << ", " << mean((ProfilePhase) p) << ", " << max((ProfilePhase) p) << "\n";
+    }
+    out << "# frame";
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        out << ", " << phaseName((ProfilePhase) p);
+    }
+    out << "\n";
+    for (int i = frames - n; i < frames; i++) {
+        out << i;
+        for (int p = 0; p < PROFILE_PHASES; p++) {
+            out << ", " << history[i % WINDOW][p] / 1e6;
+        }
+        out << "\n";
+    }
+    return true;
+}
+
+ProfileScope::ProfileScope(ProfilePhase phase)
+    : phase(phase), parent(innermost), nested(0)
+{
+    innermost = this;
+    clock.start();
+}
+
+ProfileScope::~ProfileScope()
+{
+    qint64 elapsed = clock.nsecsElapsed();
+    Profiler::add(phase, elapsed - nested);
+    if (parent) {
+        parent->nested += elapsed;
+    }
+    innermost = parent;
+}
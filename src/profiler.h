@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+// The parts of a frame the profiler tells apart. Everything but the mesh job and GPU phases is
+// CPU time on the main thread
+enum ProfilePhase {
+    PHASE_GENERATE = 0, // filling new chunks with terrain as the world shifts
+    PHASE_MESH_SUBMIT,  // starting mesh jobs for changed chunks
+    PHASE_MESH_JOBS,    // CPU time of the mesh jobs whose results arrived, on whichever threads ran them
+    PHASE_UPLOAD,       // moving meshes into the chunk arena
+    PHASE_PHYSICS,      // player physics steps in timerUpdate
+    PHASE_CULL,         // frustum, cave and occlusion culling
+    PHASE_FAR_FIELD,    // resampling and drawing the far field
+    PHASE_DRAW,         // submitting the chunk draw calls
+    PHASE_GPU_TERRAIN,  // GPU time of the far field and chunk passes, from timer queries
+    PROFILE_PHASES
+};
+
+// Rolling per-phase timings over the last WINDOW frames. Time is added to the frame in
+// progress and the frame is closed by endFrame. Only used from the main thread.
+class Profiler
+{
+public:
+    static const int WINDOW = 120;
+
+    static const char* phaseName(ProfilePhase phase);
+    static void add(ProfilePhase phase, qint64 nsecs);
+    static void endFrame();
+    // Milliseconds per frame over the window
+    static double mean(ProfilePhase phase);
+    static double max(ProfilePhase phase);
+    // Writes the statistics and every frame in the window as text; false if that fails
+    static bool dump(const QString &path);
+
+private:
+    static qint64 current[PROFILE_PHASES];
+    static qint64 history[WINDOW][PROFILE_PHASES];
+    static int frames;      // frames ended so far
+};
+
+// Adds the time until it goes out of scope to a phase. Time spent in scopes nested inside
+// it counts only toward their own phases.
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfilePhase phase);
+    ~ProfileScope();
+
+private:
+    ProfilePhase phase;
+    ProfileScope *parent;
+    qint64 nested;
+    QElapsedTimer clock;
+
+    static ProfileScope *innermost;
+};
+
+#endif // PROFILER_H
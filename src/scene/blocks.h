@@ -0,0 +1,57 @@
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include <scene/texture.h>
+
+// Properties of a block type. The low bits are copied into chunk vertices and face records
+// for the shaders, see chunk.frag.glsl
+enum BlockFlag {
+    BLOCK_ANIMATED = 1,     // the texture scrolls into the next tile over time
+    BLOCK_EMISSIVE = 2,     // drawn at double brightness
+    BLOCK_TRANSLUCENT = 4,  // see-through
+    BLOCK_OPAQUE = 8        // drawn in the opaque pass; everything else is blended after it
+};
+
+// Layer of the block tile array holding the atlas tile in column col, row row
+constexpr int atlasTile(int col, int row) { return row * 16 + col; }
+
+// One entry of the block registry. tiles is indexed by ChunkFace: +x, -x, +y, -y, +z, -z
+struct BlockInfo {
+    const char *name;
+    int flags;
+    int tiles[6];
+};
+
+// Every block type, indexed by Texture. EMPTY has an entry too, so a cell's value can index
+// the table without a branch. Adding a block means adding its Texture and a row here.
+constexpr BlockInfo BLOCKS[BLOCK_TYPES] = {
+    {"grass", BLOCK_OPAQUE,
+     {atlasTile(3, 0), atlasTile(3, 0), atlasTile(8, 2), atlasTile(2, 0), atlasTile(3, 0), atlasTile(3, 0)}},
+    {"wood", BLOCK_OPAQUE,
+     {atlasTile(4, 1), atlasTile(4, 1), atlasTile(5, 1), atlasTile(5, 1), atlasTile(4, 1), atlasTile(4, 1)}},
+    {"stone", BLOCK_OPAQUE,
+     {atlasTile(1, 0), atlasTile(1, 0), atlasTile(1, 0), atlasTile(1, 0), atlasTile(1, 0), atlasTile(1, 0)}},
+    {"lava", BLOCK_ANIMATED | BLOCK_EMISSIVE,
+     {atlasTile(13, 14), atlasTile(13, 14), atlasTile(13, 14), atlasTile(13, 14), atlasTile(13, 14), atlasTile(13, 14)}},
+    {"water", BLOCK_ANIMATED | BLOCK_TRANSLUCENT,
+     {atlasTile(13, 12), atlasTile(13, 12), atlasTile(13, 12), atlasTile(13, 12), atlasTile(13, 12), atlasTile(13, 12)}},
+    {"empty", 0, {0, 0, 0, 0, 0, 0}}
+};
+
+constexpr bool blockOpaque(Texture t) { return (BLOCKS[t].flags & BLOCK_OPAQUE) != 0; }
+constexpr int blockTile(Texture t, int face) { return BLOCKS[t].tiles[face]; }
+
+// One layer of generated terrain: the blocks below top, and not in a lower layer, are block
+struct TerrainLayer {
+    int top;
+    Texture block;
+};
+
+// The layers generated terrain is made of, from the bottom up; everything above the last one
+// is TERRAIN_SURFACE. Chunk generation and the far field both read them via Scene::terrainBlock
+constexpr TerrainLayer TERRAIN_LAYERS[] = {
+    {7, STONE}, {9, LAVA}, {12, WATER}, {13, WOOD}, {20, GRASS}, {21, WATER}
+};
+constexpr Texture TERRAIN_SURFACE = GRASS;
+
+#endif // BLOCKS_H
@@ -0,0 +1,94 @@
+#include "cavecull.h"
+#include <scene/scene.h>
+#include <scene/octnode.h>
+#include <scene/frustum.h>
+#include <QQueue>
+
+// A chunk waiting in the search queue
+struct CaveStep {
+    glm::ivec3 chunk;
+    int entered;    // the ChunkFace it was entered through, -1 for the camera's chunk
+    int moved;      // bit f is set once the path has moved out through ChunkFace f
+};
+
+// Unit step through each ChunkFace
+static const glm::ivec3 FACE_STEPS[6] = {
+    glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0),
+    glm::ivec3(0, 1, 0), glm::ivec3(0, -1, 0),
+    glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)
+};
+
+CaveCuller::CaveCuller() : active(false), stamp(0)
+{}
+
+bool CaveCuller::contains(const glm::ivec3 &c) const
+{
+    return c.x >= lo.x && c.y >= lo.y && c.z >= lo.z &&
+            c.x < lo.x + size.x && c.y < lo.y + size.y && c.z < lo.z + size.z;
+}
+
+int CaveCuller::index(const glm::ivec3 &c) const
+{
+    glm::ivec3 d = c - lo;
+    return (d.x * size.y + d.y) * size.z + d.z;
+}
+
+bool CaveCuller::isReachable(const glm::ivec3 &c) const
+{
+    if (!active || !contains(c)) {
+        return true;
+    }
+    return visited.at(index(c)) == stamp;
+}
+
+void CaveCuller::update(const Scene &scene, const Frustum &frustum, const glm::vec3 &eye, float max_distance)
+{
+    OctNode* root = scene.octree;
+    // The generated terrain plus one layer of open sky above it
+    lo = glm::ivec3(root->base.x, 0, root->base.z);
+    size = glm::ivec3(root->length, Scene::MAX_TERRAIN_HEIGHT + 1, root->length);
+    if (visited.size() != size.x * size.y * size.z) {
+        visited.fill(0, size.x * size.y * size.z);
+        stamp = 0;
+    }
+    stamp++;
+
+    glm::ivec3 start = glm::ivec3(glm::floor(eye / 16.f));
+    active = contains(start);
+    if (!active) {
+        return;
+    }
+
+    QQueue<CaveStep> queue;
+    visited[index(start)] = stamp;
+    queue.enqueue({start, -1, 0});
+    while (!queue.isEmpty()) {
+        CaveStep step = queue.dequeue();
+        const OctNode* node = root->getContainingNode(Point3(step.chunk.x, step.chunk.y, step.chunk.z));
+        // Chunks that were never generated are open air
+        const ChunkData* chunk = node && node->length == 1 ? node->chunk : nullptr;
+
+        for (int face = 0; face < 6; face++) {
+            // Moving back through a direction already taken can only lead to chunks
+            // that are reachable some shorter way, or hidden behind this one
+            if (step.moved & (1 << (face ^ 1))) {
+                continue;
+            }
+            if (step.entered != -1 && chunk && !chunk->facesConnected(step.entered, face)) {
+                continue;
+            }
+            glm::ivec3 next = step.chunk + FACE_STEPS[face];
+            if (!contains(next) || visited.at(index(next)) == stamp) {
+                continue;
+            }
+            glm::vec3 bmin = glm::vec3(next) * 16.f;
+            glm::vec3 bmax = bmin + glm::vec3(16.f);
+            if (glm::distance(glm::clamp(eye, bmin, bmax), eye) > max_distance ||
+                    frustum.classify(bmin, bmax) == Frustum::OUTSIDE) {
+                continue;
+            }
+            visited[index(next)] = stamp;
+            queue.enqueue({next, face ^ 1, step.moved | (1 << face)});
+        }
+    }
+}
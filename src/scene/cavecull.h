@@ -0,0 +1,35 @@
+#ifndef CAVECULL_H
+#define CAVECULL_H
+
+#include <la.h>
+#include <QVector>
+
+class Scene;
+class Frustum;
+
+// Cave culling: a breadth first search over the chunk grid starting at the camera's chunk.
+// The search only leaves a chunk through a face that is linked, through empty cells, to the
+// face it entered by (see ChunkData::facesConnected), so chunks sealed off underground are never
+// reached. The search also stays inside the frustum and never turns back toward the camera.
+class CaveCuller
+{
+public:
+    CaveCuller();
+
+    // Runs the search for this frame. When the eye is outside the generated terrain the
+    // search is skipped and every chunk counts as reachable.
+    void update(const Scene &scene, const Frustum &frustum, const glm::vec3 &eye, float max_distance);
+    // c is in chunk coordinates
+    bool isReachable(const glm::ivec3 &c) const;
+
+private:
+    bool active;
+    glm::ivec3 lo, size;    // searched region, in chunks
+    int stamp;              // incremented every update so visited never needs clearing
+    QVector<int> visited;   // stamp of the last update that reached each chunk of the region
+
+    bool contains(const glm::ivec3 &c) const;
+    int index(const glm::ivec3 &c) const;
+};
+
+#endif // CAVECULL_H
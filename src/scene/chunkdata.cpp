@@ -0,0 +1,241 @@
+#include "chunkdata.h"
+#include <scene/blocks.h>
+#include <vector>
+#include <algorithm>
+
+ChunkData::ChunkData(const CellGrid &cells) : cells(cells), height(0), block_count(0), opaque_count(0),
+      solid_faces(0), face_connectivity(0), revision(0)
+{
+    cells_memory.set(cellBytes(cells), 1);
+}
+
+ChunkData::ChunkData(int height) : height(height), block_count(0), opaque_count(0), solid_faces(0),
+      face_connectivity(0), revision(0)
+{
+    for (int x = 0; x < 16; x++) {
+        QList<QList<Texture>> Xs;
+        for (int y = 0; y < 16; y++) {
+            QList<Texture> Ys;
+            for (int z = 0; z < 16; z++) {
+                Ys.append(EMPTY);
+            }
+            Xs.append(Ys);
+        }
+        cells.append(Xs);
+    }
+    cells_memory.set(cellBytes(cells), 1);
+}
+
+ChunkData::~ChunkData()
+{
+    delete render;
+}
+
+void ChunkData::update()
+{
+    computeSummaries();
+    revision++;
+    if (!transition(CHUNK_GENERATING, CHUNK_DIRTY)) {
+        transition(CHUNK_READY, CHUNK_DIRTY);
+    }
+}
+
+ChunkState ChunkData::state() const
+{
+    return (ChunkState) lifecycle.load(std::memory_order_acquire);
+}
+
+bool ChunkData::transition(ChunkState from, ChunkState to)
+{
+    int expected = from;
+    return lifecycle.compare_exchange_strong(expected, to, std::memory_order_acq_rel);
+}
+
+void ChunkData::evict(ChunkData *chunk)
+{
+    int previous = chunk->lifecycle.exchange(CHUNK_EVICTING, std::memory_order_acq_rel);
+    if (previous != CHUNK_MESHING && previous != CHUNK_AWAITING_UPLOAD) {
+        delete chunk;
+    }
+}
+
+// Estimates; a QList keeps one pointer sized slot per element behind a header of about four words
+qint64 ChunkData::cellBytes(const CellGrid &grid)
+{
+    const qint64 header = 4 * sizeof(void*);
+    qint64 bytes = header + grid.size() * sizeof(void*);
+    for (const QList<QList<Texture>> &plane : grid) {
+        bytes += header + plane.size() * sizeof(void*);
+        for (const QList<Texture> &row : plane) {
+            bytes += header + row.size() * sizeof(void*);
+        }
+    }
+    return bytes;
+}
+
+bool ChunkData::isSolid() const
+{
+    return opaque_count == 16*16*16;
+}
+
+int ChunkData::facingFaces(const glm::vec3 &eye, const glm::vec3 &bmin, const glm::vec3 &bmax)
+{
+    // A face pointing along +x lies on a plane above bmin.x and is only seen from past it
+    int faces = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        if (eye[axis] > bmin[axis]) {
+            faces |= 1 << (axis * 2);
+        }
+        if (eye[axis] < bmax[axis]) {
+            faces |= 1 << (axis * 2 + 1);
+        }
+    }
+    return faces;
+}
+
+// Maps an unordered pair of distinct faces to one of 15 bits
+static int facePairBit(int a, int b)
+{
+    if (a > b) {
+        std::swap(a, b);
+    }
+    return a * (11 - a) / 2 + b - a - 1;
+}
+
+bool ChunkData::facesConnected(int a, int b) const
+{
+    return a != b && (face_connectivity & (1 << facePairBit(a, b)));
+}
+
+/**
+ * @brief ChunkData::computeConnectivity - finds which faces can see each other through the chunk
+ * Every region of connected see-through cells (empty, water, lava) is flood filled once; all the
+ * faces a region touches are linked to each other. Used by the cave culling search to skip
+ * chunks sealed off by rock.
+ */
+void ChunkData::computeConnectivity()
+{
+    face_connectivity = 0;
+    if (block_count == 0) {
+        face_connectivity = (1 << 15) - 1;
+        return;
+    }
+    if (isSolid()) {
+        return;
+    }
+
+    // Flatten the cells once; index = x*256 + y*16 + z
+    bool open[16*16*16];
+    for (int x = 0; x < 16; x++) {
+        for (int y = 0; y < 16; y++) {
+            for (int z = 0; z < 16; z++) {
+                open[x*256 + y*16 + z] = !blockOpaque(cells.at(x).at(y).at(z));
+            }
+        }
+    }
+
+    bool visited[16*16*16] = {};
+    std::vector<int> stack;
+    stack.reserve(16*16*16);
+    for (int start = 0; start < 16*16*16; start++) {
+        if (!open[start] || visited[start]) {
+            continue;
+        }
+        int touched = 0;
+        visited[start] = true;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int i = stack.back();
+            stack.pop_back();
+            int x = i >> 8, y = (i >> 4) & 15, z = i & 15;
+            if (x == 15) touched |= 1 << FACE_POS_X;
+            if (x == 0) touched |= 1 << FACE_NEG_X;
+            if (y == 15) touched |= 1 << FACE_POS_Y;
+            if (y == 0) touched |= 1 << FACE_NEG_Y;
+            if (z == 15) touched |= 1 << FACE_POS_Z;
+            if (z == 0) touched |= 1 << FACE_NEG_Z;
+
+            int neighbors[6] = {x < 15 ? i + 256 : -1, x > 0 ? i - 256 : -1,
+                                y < 15 ? i + 16 : -1, y > 0 ? i - 16 : -1,
+                                z < 15 ? i + 1 : -1, z > 0 ? i - 1 : -1};
+            for (int n : neighbors) {
+                if (n >= 0 && open[n] && !visited[n]) {
+                    visited[n] = true;
+                    stack.push_back(n);
+                }
+            }
+        }
+        for (int a = 0; a < 6; a++) {
+            for (int b = a + 1; b < 6; b++) {
+                if ((touched & (1 << a)) && (touched & (1 << b))) {
+                    face_connectivity |= 1 << facePairBit(a, b);
+                }
+            }
+        }
+    }
+}
+
+void ChunkData::computeSummaries()
+{
+    block_count = 0;
+    opaque_count = 0;
+    // Start with every face solid and clear the bit of any face whose layer can be seen through
+    solid_faces = (1 << 6) - 1;
+    for (int x = 0; x < 16; x++) {
+        for (int y = 0; y < 16; y++) {
+            for (int z = 0; z < 16; z++) {
+                Texture t = cells.at(x).at(y).at(z);
+                if (t != EMPTY) {
+                    block_count++;
+                }
+                if (blockOpaque(t)) {
+                    opaque_count++;
+                    continue;
+                }
+                if (x == 15) solid_faces &= ~(1 << FACE_POS_X);
+                if (x == 0) solid_faces &= ~(1 << FACE_NEG_X);
+                if (y == 15) solid_faces &= ~(1 << FACE_POS_Y);
+                if (y == 0) solid_faces &= ~(1 << FACE_NEG_Y);
+                if (z == 15) solid_faces &= ~(1 << FACE_POS_Z);
+                if (z == 0) solid_faces &= ~(1 << FACE_NEG_Z);
+            }
+        }
+    }
+    computeConnectivity();
+}
+
+/**
+ * @brief ChunkData::downsample - halves the resolution of a cubic grid
+ * A new cell is filled when at least half of the 2x2x2 cells it covers are, with their most
+ * common block type. Ties go to filled so thin surfaces like the top layer of grass survive.
+ */
+CellGrid ChunkData::downsample(const CellGrid &grid)
+{
+    int size = grid.size() / 2;
+    CellGrid result;
+    for (int x = 0; x < size; x++) {
+        QList<QList<Texture>> Xs;
+        for (int y = 0; y < size; y++) {
+            QList<Texture> Ys;
+            for (int z = 0; z < size; z++) {
+                int counts[BLOCK_TYPES] = {};
+                for (int i = 0; i < 8; i++) {
+                    counts[grid.at(2*x + (i >> 2)).at(2*y + ((i >> 1) & 1)).at(2*z + (i & 1))]++;
+                }
+                int best = EMPTY;
+                if (counts[EMPTY] <= 4) {
+                    best = 0;
+                    for (int t = 1; t < EMPTY; t++) {
+                        if (counts[t] > counts[best]) {
+                            best = t;
+                        }
+                    }
+                }
+                Ys.append((Texture) best);
+            }
+            Xs.append(Ys);
+        }
+        result.append(Xs);
+    }
+    return result;
+}
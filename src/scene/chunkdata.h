@@ -0,0 +1,87 @@
+#ifndef CHUNKDATA_H
+#define CHUNKDATA_H
+
+#include <scene/texture.h>
+#include <memorystats.h>
+#include <la.h>
+#include <QList>
+#include <atomic>
+
+// The six boundary faces of a chunk, used as bit indices in the chunk summaries
+enum ChunkFace {
+    FACE_POS_X = 0, FACE_NEG_X, FACE_POS_Y, FACE_NEG_Y, FACE_POS_Z, FACE_NEG_Z
+};
+
+typedef QList<QList<QList<Texture>>> CellGrid;
+
+// Where a chunk is in its life. Each transition is a compare-and-swap, so of two threads racing
+// to move a chunk on only one succeeds:
+//   GENERATING -> DIRTY            update() once the cells are filled in
+//   READY -> DIRTY                 update() after an edit
+//   DIRTY -> MESHING               the render thread hands a copy of the cells to a mesh job
+//   MESHING -> AWAITING_UPLOAD     the job queued the mesh for the render thread
+//   AWAITING_UPLOAD -> READY       the render thread uploaded it
+//   AWAITING_UPLOAD -> DIRTY       the cells changed while it was built, so it was dropped
+//   any -> EVICTING                the chunk left the world, see ChunkData::evict
+// Edits don't change MESHING or AWAITING_UPLOAD; the revision they bump tells the render thread
+// the mesh is stale. Those two states mean a mesh is in flight, which keeps the chunk alive.
+enum ChunkState {
+    CHUNK_GENERATING = 0, CHUNK_DIRTY, CHUNK_MESHING, CHUNK_AWAITING_UPLOAD, CHUNK_READY, CHUNK_EVICTING
+};
+
+// Whatever a renderer keeps per chunk, such as its meshes. Owned by the chunk, so it is freed
+// along with it
+class ChunkRenderData
+{
+public:
+    virtual ~ChunkRenderData() {}
+};
+
+// The cells of a 16x16x16 block of the world and summaries of them. Holds no GL resources, so
+// chunks can be generated and edited without a context; a renderer attaches what it draws the
+// chunk with as render.
+class ChunkData
+{
+public:
+    // Takes in a 16x16x16 list of Textures indicating what the cell is occupied by
+    ChunkData(const CellGrid &cells);
+    // Every cell EMPTY
+    ChunkData(int height);
+    ~ChunkData();
+
+    // Refreshes the summaries and marks the chunk for meshing; call after changing the cells
+    void update();
+    ChunkState state() const;
+    // Moves the chunk from one state to another; false, and no change, if it wasn't in from
+    bool transition(ChunkState from, ChunkState to);
+    // Takes a chunk out of the world. It is freed right away unless a mesh of it is in flight;
+    // then the render thread frees it when the mesh comes back. Only call on the main thread
+    static void evict(ChunkData *chunk);
+
+    CellGrid cells;
+    int height;
+    glm::ivec3 cell = glm::ivec3(0);    // position in chunks, set by OctNode::setChunk; labels trace events
+    // Summaries refreshed by update()
+    int block_count;    // number of non-EMPTY cells
+    int opaque_count;   // number of cells that hide what is behind them, see blockOpaque
+    int solid_faces;    // bit f is set when the 16x16 layer of cells along ChunkFace f is all opaque
+    int face_connectivity;  // one bit per pair of faces linked through see-through cells, see facesConnected
+    int revision;       // counts calls to update(), so renderers can tell their meshes are stale
+    ChunkRenderData *render = nullptr;
+
+    bool isSolid() const;
+    bool facesConnected(int a, int b) const;
+    // Bit f is set when faces pointing along ChunkFace f inside the box can face the eye
+    static int facingFaces(const glm::vec3 &eye, const glm::vec3 &bmin, const glm::vec3 &bmax);
+    static CellGrid downsample(const CellGrid &grid);
+
+private:
+    MemoryGauge cells_memory{MEM_CHUNK_CELLS};
+    std::atomic<int> lifecycle{CHUNK_GENERATING};
+
+    void computeSummaries();
+    void computeConnectivity();
+    static qint64 cellBytes(const CellGrid &grid);
+};
+
+#endif // CHUNKDATA_H
@@ -0,0 +1,54 @@
+#include "frustum.h"
+
+Frustum::Frustum()
+{}
+
+Frustum::Frustum(const glm::mat4 &viewproj)
+{
+    // glm matrices are column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::mat4 &m = viewproj;
+    glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0;    // left
+    planes[1] = row3 - row0;    // right
+    planes[2] = row3 + row1;    // bottom
+    planes[3] = row3 - row1;    // top
+    planes[4] = row3 + row2;    // near
+    planes[5] = row3 - row2;    // far
+
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+/**
+ * @brief Frustum::classify - tests an axis aligned box against all six planes
+ * @param bmin - smallest corner of the box
+ * @param bmax - largest corner of the box
+ * @return OUTSIDE if the box is entirely behind one plane, INSIDE if it is in front of
+ * all of them, and INTERSECTS otherwise
+ */
+Frustum::Result Frustum::classify(const glm::vec3 &bmin, const glm::vec3 &bmax) const
+{
+    Result result = INSIDE;
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4 &plane = planes[i];
+        // The corners furthest along and furthest against the plane normal
+        glm::vec3 positive = glm::vec3(plane.x >= 0 ? bmax.x : bmin.x,
+                                       plane.y >= 0 ? bmax.y : bmin.y,
+                                       plane.z >= 0 ? bmax.z : bmin.z);
+        glm::vec3 negative = glm::vec3(plane.x >= 0 ? bmin.x : bmax.x,
+                                       plane.y >= 0 ? bmin.y : bmax.y,
+                                       plane.z >= 0 ? bmin.z : bmax.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0) {
+            return OUTSIDE;
+        }
+        if (glm::dot(glm::vec3(plane), negative) + plane.w < 0) {
+            result = INTERSECTS;
+        }
+    }
+    return result;
+}
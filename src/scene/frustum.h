@@ -0,0 +1,24 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <la.h>
+
+// The six clipping planes of a view-projection matrix, used to cull boxes on the CPU
+class Frustum
+{
+public:
+    enum Result {
+        OUTSIDE, INTERSECTS, INSIDE
+    };
+
+    Frustum();
+    // Extracts the planes from a combined projection * view matrix (Gribb & Hartmann)
+    Frustum(const glm::mat4 &viewproj);
+
+    Result classify(const glm::vec3 &bmin, const glm::vec3 &bmax) const;
+
+private:
+    glm::vec4 planes[6];    // xyz = inward normal, w = distance; normalized
+};
+
+#endif // FRUSTUM_H
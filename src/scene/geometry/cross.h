@@ -1,16 +0,0 @@
-#ifndef CROSS_H
-#define CROSS_H
-
-#include "OpenGL/drawable.h"
-#include <iostream>
-
-class Cross : public Drawable
-{
-public:
-    Cross();
-    //DRAWING the center of the screen as a plus
-    virtual GLenum drawMode();
-    void create();
-};
-
-#endif // CROSS_H
@@ -146,6 +146,7 @@ void Cube::create()
 
     count = CUB_IDX_COUNT;
 
+    beginVAO();
     bufIdx.create();
     bufIdx.bind();
     bufIdx.setUsagePattern(QOpenGLBuffer::StaticDraw);
@@ -165,5 +166,5 @@ void Cube::create()
     bufCol.bind();
     bufCol.setUsagePattern(QOpenGLBuffer::StaticDraw);
     bufCol.allocate(cub_vert_col, CUB_VERT_COUNT * sizeof(glm::vec3));
-
+    endVAO();
 }
@@ -110,6 +110,7 @@ void Cylinder::create()
 
     count = CYL_IDX_COUNT;
 
+    beginVAO();
     bufIdx.create();
     bufIdx.bind();
     bufIdx.setUsagePattern(QOpenGLBuffer::StaticDraw);
@@ -124,4 +125,5 @@ void Cylinder::create()
     bufNor.bind();
     bufNor.setUsagePattern(QOpenGLBuffer::StaticDraw);
     bufNor.allocate(cyl_vert_nor, CYL_VERT_COUNT * sizeof(glm::vec4));
+    endVAO();
 }
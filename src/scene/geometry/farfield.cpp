@@ -0,0 +1,157 @@
+#include "farfield.h"
+#include <scene/scene.h>
+#include <scene/blocks.h>
+
+const int FarField::LEVELS;
+const int FarField::CELLS;
+const int FarField::BASE_SPACING;
+
+// Center of the block's top texture in the atlas, so distant quads get its average color
+// instead of a minified, shimmering copy of the tile. w = 1 marks emissive blocks like lava.
+static glm::vec4 farFieldUV(Texture t)
+{
+    int tile = blockTile(t, FACE_POS_Y);
+    float emissive = (BLOCKS[t].flags & BLOCK_EMISSIVE) ? 1 : 0;
+    return glm::vec4((tile % 16 + 0.5f) / 16.f, (tile / 16 + 0.5f) / 16.f, 0, emissive);
+}
+
+FarFieldRing::FarFieldRing()
+    : spacing(0), corner(0), hole(0), valid(false)
+{}
+
+void FarFieldRing::create()
+{
+    const int N = FarField::CELLS;
+    std::vector<GLuint> idx;
+    std::vector<glm::vec3> pos;
+    std::vector<glm::vec3> nor;
+    std::vector<glm::vec4> uv;
+
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            int x = corner.x + i * spacing;
+            int z = corner.y + j * spacing;
+            // Levels are aligned so each quad is either entirely inside the hole or outside it
+            if (x >= hole.x && x + spacing <= hole.z && z >= hole.y && z + spacing <= hole.w) {
+                continue;
+            }
+            float h00 = heights[i * (N + 1) + j];
+            float h10 = heights[(i + 1) * (N + 1) + j];
+            float h11 = heights[(i + 1) * (N + 1) + j + 1];
+            float h01 = heights[i * (N + 1) + j + 1];
+            glm::vec3 p00(x, h00, z), p10(x + spacing, h10, z);
+            glm::vec3 p11(x + spacing, h11, z + spacing), p01(x, h01, z + spacing);
+
+            // Both triangles share the normal of the quad's diagonals
+            glm::vec3 n = glm::normalize(glm::cross(p01 - p10, p11 - p00));
+            glm::vec4 t = farFieldUV(Scene::terrainBlock((int) ceil((h00 + h10 + h11 + h01) / 4.f) - 1));
+
+            GLuint first = pos.size();
+            pos.push_back(p00);
+            pos.push_back(p10);
+            pos.push_back(p11);
+            pos.push_back(p01);
+            for (int k = 0; k < 4; k++) {
+                nor.push_back(n);
+                uv.push_back(t);
+            }
+            idx.push_back(first);
+            idx.push_back(first + 2);
+            idx.push_back(first + 1);
+            idx.push_back(first);
+            idx.push_back(first + 3);
+            idx.push_back(first + 2);
+        }
+    }
+
+    count = idx.size();
+
+    beginVAO();
+    bufIdx.create();
+    bufIdx.bind();
+    bufIdx.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufIdx.allocate(idx.data(), idx.size() * sizeof(GLuint));
+
+    bufPos.create();
+    bufPos.bind();
+    bufPos.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufPos.allocate(pos.data(), pos.size() * sizeof(glm::vec3));
+
+    bufNor.create();
+    bufNor.bind();
+    bufNor.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufNor.allocate(nor.data(), nor.size() * sizeof(glm::vec3));
+
+    bufUV.create();
+    bufUV.bind();
+    bufUV.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufUV.allocate(uv.data(), uv.size() * sizeof(glm::vec4));
+    endVAO();
+}
+
+/**
+ * @brief FarField::update - re-centers every level on the camera and re-samples the ones that moved
+ * Level l has a spacing of BASE_SPACING << l and is snapped to twice its spacing, which keeps
+ * each level's outline on the grid of the level around it. The hole of level 0 is the window of
+ * loaded chunks; the hole of every other level is the square covered by the level inside it.
+ * @param scene - supplies the terrain heights
+ * @param eye - the camera position
+ * @param near_min - smallest x/z of the loaded chunks
+ * @param near_max - largest x/z of the loaded chunks
+ */
+void FarField::update(Scene &scene, const glm::vec3 &eye, const glm::ivec2 &near_min, const glm::ivec2 &near_max)
+{
+    const int N = CELLS;
+    glm::ivec4 hole(near_min.x, near_min.y, near_max.x, near_max.y);
+    for (int l = 0; l < LEVELS; l++) {
+        FarFieldRing &ring = rings[l];
+        int spacing = BASE_SPACING << l;
+        int snap = 2 * spacing;
+        glm::ivec2 center((int) floor(eye.x / snap + 0.5f) * snap,
+                          (int) floor(eye.z / snap + 0.5f) * snap);
+        glm::ivec2 corner = center - glm::ivec2(N / 2 * spacing);
+
+        if (!ring.valid || ring.spacing != spacing || ring.corner != corner || ring.hole != hole) {
+            ring.spacing = spacing;
+            ring.corner = corner;
+            ring.hole = hole;
+            ring.heights.resize((N + 1) * (N + 1));
+            float max_height = Scene::MAX_TERRAIN_HEIGHT * 16.f;
+            for (int i = 0; i <= N; i++) {
+                for (int j = 0; j <= N; j++) {
+                    float h = scene.terrainHeight(corner.x + i * spacing, corner.y + j * spacing);
+                    ring.heights[i * (N + 1) + j] = glm::min(h, max_height);
+                }
+            }
+            // The level outside only has a vertex at every other one of ours along the shared
+            // edge; putting the odd ones on the line between their neighbours closes the cracks
+            if (l < LEVELS - 1) {
+                float *h = ring.heights.data();
+                for (int k = 1; k < N; k += 2) {
+                    // Edges along x step by a whole row, edges along z by one sample
+                    for (int at : {k * (N + 1), k * (N + 1) + N}) {
+                        h[at] = 0.5f * (h[at - (N + 1)] + h[at + (N + 1)]);
+                    }
+                    for (int at : {k, N * (N + 1) + k}) {
+                        h[at] = 0.5f * (h[at - 1] + h[at + 1]);
+                    }
+                }
+            }
+            ring.recreate();
+            ring.valid = true;
+        }
+        hole = glm::ivec4(corner, corner + glm::ivec2(N * spacing));
+    }
+}
+
+void FarField::invalidate()
+{
+    for (int l = 0; l < LEVELS; l++) {
+        rings[l].valid = false;
+    }
+}
+
+float FarField::extent() const
+{
+    return glm::sqrt(2.f) * (CELLS / 2 + 2) * (BASE_SPACING << (LEVELS - 1));
+}
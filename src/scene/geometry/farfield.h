@@ -0,0 +1,46 @@
+#ifndef FARFIELD_H
+#define FARFIELD_H
+
+#include <openGL/drawable.h>
+#include <scene/texture.h>
+#include <QVector>
+
+class Scene;
+
+// One square level of the far field clipmap: a CELLS x CELLS grid of quads spaced `spacing`
+// blocks apart, with the square covered by the next finer level (or the loaded chunks) cut out.
+class FarFieldRing : public Drawable
+{
+public:
+    FarFieldRing();
+    void create();
+
+    int spacing;                // blocks between samples
+    glm::ivec2 corner;          // smallest x/z of the ring, in blocks
+    glm::ivec4 hole;            // xmin, zmin, xmax, zmax of the region left empty
+    QVector<float> heights;     // (CELLS + 1)^2 terrain heights at the grid corners
+    bool valid;                 // false until heights match corner and hole
+};
+
+// Draws the terrain beyond the loaded chunks as a coarse heightfield, sampled from the same
+// terrain function (and imported heightmap) that generates chunks. Each level doubles the
+// spacing of the one inside it and is re-centered on the camera independently, so only the
+// levels whose snapped position changed are re-sampled as the camera moves.
+class FarField
+{
+public:
+    static const int LEVELS = 5;
+    static const int CELLS = 32;        // quads per side of each level
+    static const int BASE_SPACING = 8;  // blocks between samples on the finest level
+
+    // Re-samples the levels that moved. near_min/near_max bound the loaded chunk window (x/z)
+    void update(Scene &scene, const glm::vec3 &eye, const glm::ivec2 &near_min, const glm::ivec2 &near_max);
+    // Forces every level to be re-sampled, e.g. after a heightmap import
+    void invalidate();
+    // Distance from the camera to the outer edge of the coarsest level
+    float extent() const;
+
+    FarFieldRing rings[LEVELS];
+};
+
+#endif // FARFIELD_H
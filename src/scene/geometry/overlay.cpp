@@ -0,0 +1,302 @@
+#include "overlay.h"
+#include <scene/blocks.h>
+#include <scene/chunkdata.h>
+#include <profiler.h>
+#include <memorystats.h>
+#include <algorithm>
+
+static const float CROSSHAIR_ARM = 10.f;    // pixels from the center to the end of each line
+static const float CROSSHAIR_WIDTH = 2.f;
+static const float SLOT_SIZE = 80.f;
+static const float SLOT_SPACING = 10.f;
+static const float ICON_SIZE = 60.f;
+static const float SELECTED_BORDER = 5.f;
+static const float BAR_MARGIN = 12.f;       // between the bar and the bottom of the screen
+static const float DIGIT_PIXEL = 3.f;
+static const float PROFILE_PIXEL = 2.f;
+static const float PROFILE_MARGIN = 8.f;
+static const float PROFILE_ROW = 14.f;
+static const float PROFILE_BAR_SCALE = 20.f;   // pixels per millisecond
+static const float PROFILE_BAR_MAX = 200.f;
+
+// 3 x 5 bitmaps, row by row from the top
+static const char *DIGITS[10] = {
+    "111101101101111", "010110010010111", "111001111100111", "111001111001111", "101101111001001",
+    "111100111001111", "111100111101111", "111001001001001", "111101111101111", "111101111001111"
+};
+static const char *LETTERS[26] = {
+    "010101111101101", "110101110101110", "011100100100011", "110101101101110", "111100110100111",
+    "111100110100100", "011100101101011", "101101111101101", "111010010010111", "001001001101010",
+    "101101110101101", "100100100100111", "101111111101101", "110101101101101", "010101101101010",
+    "110101110100100", "010101101110011", "110101110101101", "011100010001110", "111010010010010",
+    "101101101101111", "101101101101010", "101101111111101", "101101010101101", "101101010010010",
+    "111001010100111"
+};
+static const char *DOT = "000000000000010";
+static const char *SLASH = "001001010100100";
+
+static const char* glyph(QChar c)
+{
+    char l = c.toUpper().toLatin1();
+    if (l >= '0' && l <= '9') {
+        return DIGITS[l - '0'];
+    } else if (l >= 'A' && l <= 'Z') {
+        return LETTERS[l - 'A'];
+    } else if (l == '.') {
+        return DOT;
+    } else if (l == '/') {
+        return SLASH;
+    }
+    return nullptr;
+}
+
+Overlay::Overlay()
+    : inventory(nullptr), width(1), height(1), show_inventory(true), show_profile(false), show_memory(false),
+      dirty(true)
+{}
+
+void Overlay::resize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    dirty = true;
+}
+
+void Overlay::setInventory(const Inventory *inventory)
+{
+    this->inventory = inventory;
+    dirty = true;
+}
+
+void Overlay::setInventoryVisible(bool visible)
+{
+    show_inventory = visible;
+    dirty = true;
+}
+
+bool Overlay::inventoryVisible() const
+{
+    return show_inventory;
+}
+
+void Overlay::setProfileVisible(bool visible)
+{
+    show_profile = visible;
+    dirty = true;
+}
+
+bool Overlay::profileVisible() const
+{
+    return show_profile;
+}
+
+void Overlay::setMemoryVisible(bool visible)
+{
+    show_memory = visible;
+    dirty = true;
+}
+
+bool Overlay::memoryVisible() const
+{
+    return show_memory;
+}
+
+void Overlay::invalidate()
+{
+    dirty = true;
+}
+
+void Overlay::refresh()
+{
+    if (dirty) {
+        recreate();
+        dirty = false;
+    }
+}
+
+glm::mat4 Overlay::projection() const
+{
+    return glm::ortho(0.f, (float) width, (float) height, 0.f);
+}
+
+void Overlay::addQuad(const glm::vec2 &min, const glm::vec2 &max, const glm::vec3 &color, float alpha, int layer)
+{
+    GLuint first = pos.size();
+    pos.push_back(glm::vec3(min.x, min.y, 0));
+    pos.push_back(glm::vec3(max.x, min.y, 0));
+    pos.push_back(glm::vec3(max.x, max.y, 0));
+    pos.push_back(glm::vec3(min.x, max.y, 0));
+    uv.push_back(glm::vec4(0, 0, layer, alpha));
+    uv.push_back(glm::vec4(1, 0, layer, alpha));
+    uv.push_back(glm::vec4(1, 1, layer, alpha));
+    uv.push_back(glm::vec4(0, 1, layer, alpha));
+    for (int i = 0; i < 4; i++) {
+        col.push_back(color);
+    }
+    idx.push_back(first);
+    idx.push_back(first + 1);
+    idx.push_back(first + 2);
+    idx.push_back(first);
+    idx.push_back(first + 2);
+    idx.push_back(first + 3);
+}
+
+void Overlay::addText(const QString &text, const glm::vec2 &left_top, float pixel, const glm::vec3 &color)
+{
+    for (int c = 0; c < text.size(); c++) {
+        const char *bits = glyph(text.at(c));
+        for (int i = 0; bits && i < 15; i++) {
+            if (bits[i] == '1') {
+                glm::vec2 p(left_top.x + (4 * c + i % 3) * pixel, left_top.y + (i / 3) * pixel);
+                addQuad(p, p + glm::vec2(pixel), color, 1);
+            }
+        }
+    }
+}
+
+void Overlay::addTextRight(const QString &text, const glm::vec2 &right_top, float pixel, const glm::vec3 &color)
+{
+    // Characters are 4 pixels apart, the last without the gap after it
+    addText(text, right_top - glm::vec2((4 * text.size() - 1) * pixel, 0), pixel, color);
+}
+
+/**
+ * @brief Overlay::addProfile - the profiler panel in the top left corner
+ * One row per phase with its mean and longest time per frame over the profiler's window, in
+ * milliseconds, and a bar as long as the mean.
+ */
+void Overlay::addProfile()
+{
+    const float name_x = PROFILE_MARGIN * 2;
+    const float mean_right = name_x + 12 * 4 * PROFILE_PIXEL + 6 * 4 * PROFILE_PIXEL;
+    const float max_right = mean_right + 7 * 4 * PROFILE_PIXEL;
+    const float bar_x = max_right + PROFILE_MARGIN * 2;
+    glm::vec2 corner(PROFILE_MARGIN);
+    addQuad(corner, corner + glm::vec2(bar_x + PROFILE_BAR_MAX, (PROFILE_PHASES + 1) * PROFILE_ROW + PROFILE_MARGIN * 2),
+            glm::vec3(0), 0.5f);
+
+    glm::vec3 white(1, 1, 1);
+    float y = corner.y + PROFILE_MARGIN;
+    addText("phase", glm::vec2(name_x, y), PROFILE_PIXEL, white);
+    addTextRight("mean", glm::vec2(mean_right, y), PROFILE_PIXEL, white);
+    addTextRight("max ms", glm::vec2(max_right, y), PROFILE_PIXEL, white);
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        ProfilePhase phase = (ProfilePhase) p;
+        y += PROFILE_ROW;
+        double mean = Profiler::mean(phase);
+        glm::vec3 color = phase == PHASE_GPU_TERRAIN ? glm::vec3(0.5f, 1, 0.5f) : glm::vec3(1, 1, 0.5f);
+        addText(Profiler::phaseName(phase), glm::vec2(name_x, y), PROFILE_PIXEL, color);
+        addTextRight(QString::number(mean, 'f', 2), glm::vec2(mean_right, y), PROFILE_PIXEL, white);
+        addTextRight(QString::number(Profiler::max(phase), 'f', 2), glm::vec2(max_right, y), PROFILE_PIXEL, white);
+        float bar = std::min((float) mean * PROFILE_BAR_SCALE, PROFILE_BAR_MAX);
+        addQuad(glm::vec2(bar_x, y), glm::vec2(bar_x + bar, y + 5 * PROFILE_PIXEL), color, 0.8f);
+    }
+}
+
+/**
+ * @brief Overlay::addMemory - the memory panel in the top right corner
+ * One row per MemoryStats subsystem with its object count and its current and peak size in
+ * megabytes. GPU subsystems are drawn in green, like the GPU row of the profiler panel.
+ */
+void Overlay::addMemory()
+{
+    const float panel_width = PROFILE_MARGIN * 2 + (16 + 9 + 9 + 9) * 4 * PROFILE_PIXEL;
+    glm::vec2 corner(width - PROFILE_MARGIN - panel_width, PROFILE_MARGIN);
+    addQuad(corner, corner + glm::vec2(panel_width, (MEMORY_SUBSYSTEMS + 1) * PROFILE_ROW + PROFILE_MARGIN * 2),
+            glm::vec3(0), 0.5f);
+
+    const float name_x = corner.x + PROFILE_MARGIN;
+    const float count_right = name_x + (16 + 9) * 4 * PROFILE_PIXEL;
+    const float mb_right = count_right + 9 * 4 * PROFILE_PIXEL;
+    const float peak_right = mb_right + 9 * 4 * PROFILE_PIXEL;
+    glm::vec3 white(1, 1, 1);
+    float y = corner.y + PROFILE_MARGIN;
+    addText("memory", glm::vec2(name_x, y), PROFILE_PIXEL, white);
+    addTextRight("objects", glm::vec2(count_right, y), PROFILE_PIXEL, white);
+    addTextRight("mb", glm::vec2(mb_right, y), PROFILE_PIXEL, white);
+    addTextRight("peak", glm::vec2(peak_right, y), PROFILE_PIXEL, white);
+    for (int i = 0; i < MEMORY_SUBSYSTEMS; i++) {
+        MemorySubsystem s = (MemorySubsystem) i;
+        y += PROFILE_ROW;
+        glm::vec3 color = MemoryStats::onGpu(s) ? glm::vec3(0.5f, 1, 0.5f) : glm::vec3(1, 1, 0.5f);
+        addText(MemoryStats::name(s), glm::vec2(name_x, y), PROFILE_PIXEL, color);
+        addTextRight(QString::number(MemoryStats::objects(s)), glm::vec2(count_right, y), PROFILE_PIXEL, white);
+        addTextRight(QString::number(MemoryStats::bytes(s) / 1048576.0, 'f', 2), glm::vec2(mb_right, y),
+                     PROFILE_PIXEL, white);
+        addTextRight(QString::number(MemoryStats::peakBytes(s) / 1048576.0, 'f', 2), glm::vec2(peak_right, y),
+                     PROFILE_PIXEL, white);
+    }
+}
+
+/**
+ * @brief Overlay::create - lays out every quad of the overlay and uploads them
+ * The inventory bar is centered along the bottom of the screen: a translucent slot per block
+ * type holding its icon and count, with the selected slot outlined. Later quads draw over
+ * earlier ones, so each slot adds its background first.
+ */
+void Overlay::create()
+{
+    idx.clear();
+    pos.clear();
+    col.clear();
+    uv.clear();
+
+    glm::vec2 center(width / 2.f, height / 2.f);
+    glm::vec3 white(1, 1, 1);
+    addQuad(center - glm::vec2(CROSSHAIR_WIDTH / 2, CROSSHAIR_ARM),
+            center + glm::vec2(CROSSHAIR_WIDTH / 2, CROSSHAIR_ARM), white, 1);
+    addQuad(center - glm::vec2(CROSSHAIR_ARM, CROSSHAIR_WIDTH / 2),
+            center + glm::vec2(CROSSHAIR_ARM, CROSSHAIR_WIDTH / 2), white, 1);
+
+    if (show_inventory && inventory != nullptr) {
+        float bar_width = Inventory::SLOTS * SLOT_SIZE + (Inventory::SLOTS - 1) * SLOT_SPACING;
+        glm::vec2 slot(center.x - bar_width / 2, height - BAR_MARGIN - SLOT_SIZE);
+        for (int i = 0; i < Inventory::SLOTS; i++) {
+            Texture t = (Texture) i;
+            glm::vec2 icon = slot + glm::vec2((SLOT_SIZE - ICON_SIZE) / 2);
+            addQuad(slot, slot + glm::vec2(SLOT_SIZE), white, 0.2f);
+            if (t == inventory->selected()) {
+                addQuad(icon - glm::vec2(SELECTED_BORDER), icon + glm::vec2(ICON_SIZE + SELECTED_BORDER),
+                        glm::vec3(1, 1, 0), 1);
+            }
+            addQuad(icon, icon + glm::vec2(ICON_SIZE), white, 1, blockTile(t, FACE_POS_X));
+            // A dark copy behind the count keeps it readable over bright tiles
+            QString count = QString::number(inventory->count(t));
+            glm::vec2 corner = slot + glm::vec2(SLOT_SIZE - 2 * DIGIT_PIXEL, SLOT_SIZE - 7 * DIGIT_PIXEL);
+            addTextRight(count, corner + glm::vec2(DIGIT_PIXEL), DIGIT_PIXEL, glm::vec3(0));
+            addTextRight(count, corner, DIGIT_PIXEL, white);
+            slot.x += SLOT_SIZE + SLOT_SPACING;
+        }
+    }
+
+    if (show_profile) {
+        addProfile();
+    }
+    if (show_memory) {
+        addMemory();
+    }
+
+    count = idx.size();
+
+    beginVAO();
+    bufIdx.create();
+    bufIdx.bind();
+    bufIdx.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufIdx.allocate(idx.data(), idx.size() * sizeof(GLuint));
+
+    bufPos.create();
+    bufPos.bind();
+    bufPos.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufPos.allocate(pos.data(), pos.size() * sizeof(glm::vec3));
+
+    bufCol.create();
+    bufCol.bind();
+    bufCol.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufCol.allocate(col.data(), col.size() * sizeof(glm::vec3));
+
+    bufUV.create();
+    bufUV.bind();
+    bufUV.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    bufUV.allocate(uv.data(), uv.size() * sizeof(glm::vec4));
+    endVAO();
+}
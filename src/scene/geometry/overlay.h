@@ -0,0 +1,62 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <openGL/drawable.h>
+#include <scene/inventory.h>
+#include <vector>
+#include <QString>
+
+// The crosshair, inventory bar, profiler panel and memory panel drawn over the scene, as one batch of
+// screen-space quads.
+// Positions are in pixels with y pointing down. Block icons are sampled from the tile array;
+// uv.z is the tile's layer, or -1 for a quad of plain color, and uv.w is the quad's alpha.
+class Overlay : public Drawable
+{
+public:
+    Overlay();
+    void create();
+
+    // Lays the quads out for a screen of width x height pixels
+    void resize(int width, int height);
+    void setInventory(const Inventory *inventory);
+    void setInventoryVisible(bool visible);
+    bool inventoryVisible() const;
+    // The per-phase frame timings from Profiler; they change every frame, so invalidate it then
+    void setProfileVisible(bool visible);
+    bool profileVisible() const;
+    // The counters of MemoryStats; invalidate it every frame too while shown
+    void setMemoryVisible(bool visible);
+    bool memoryVisible() const;
+    // Marks the quads out of date, e.g. after the inventory changed
+    void invalidate();
+    // Rebuilds the buffers if anything changed since the last call
+    void refresh();
+    // Maps the overlay's pixel coordinates to clip space
+    glm::mat4 projection() const;
+
+private:
+    void addQuad(const glm::vec2 &min, const glm::vec2 &max, const glm::vec3 &color, float alpha,
+                 int layer = -1);
+    // Draws text with its top left corner at left_top. Each character is up to 3 x 5 quads of
+    // the given pixel size; only digits, letters (drawn in capitals), '.', '/' and spaces show
+    void addText(const QString &text, const glm::vec2 &left_top, float pixel, const glm::vec3 &color);
+    // Same, but with the top right corner at right_top
+    void addTextRight(const QString &text, const glm::vec2 &right_top, float pixel, const glm::vec3 &color);
+    void addProfile();
+    void addMemory();
+
+    const Inventory *inventory;
+    int width, height;
+    bool show_inventory;
+    bool show_profile;
+    bool show_memory;
+    bool dirty;
+
+    // Quads of the layout being built
+    std::vector<GLuint> idx;
+    std::vector<glm::vec3> pos;
+    std::vector<glm::vec3> col;
+    std::vector<glm::vec4> uv;
+};
+
+#endif // OVERLAY_H
@@ -47,6 +47,7 @@ void LineSeg::createSeg(glm::vec4 pos1, glm::vec4 pos2, glm::vec4 col1, glm::vec
 
     count = SEG_IDX;
 
+    beginVAO();
     bufIdx.create();
     bufIdx.bind();
     bufIdx.setUsagePattern(QOpenGLBuffer::StaticDraw);
@@ -61,4 +62,5 @@ void LineSeg::createSeg(glm::vec4 pos1, glm::vec4 pos2, glm::vec4 col1, glm::vec
     bufCol.bind();
     bufCol.setUsagePattern(QOpenGLBuffer::StaticDraw);
     bufCol.allocate(sph_vert_col, SEG_VERT * sizeof(glm::vec4));
+    endVAO();
 }
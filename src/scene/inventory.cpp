@@ -0,0 +1,44 @@
+#include "inventory.h"
+
+const int Inventory::SLOTS;
+
+Inventory::Inventory()
+    : current(GRASS)
+{
+    for (int i = 0; i < SLOTS; i++) {
+        counts[i] = 0;
+    }
+}
+
+Texture Inventory::take()
+{
+    if (counts[current] == 0) {
+        return EMPTY;
+    }
+    counts[current]--;
+    return current;
+}
+
+void Inventory::give(Texture t)
+{
+    if (t != EMPTY) {
+        counts[t]++;
+    }
+}
+
+void Inventory::select(Texture t)
+{
+    if (t != EMPTY) {
+        current = t;
+    }
+}
+
+Texture Inventory::selected() const
+{
+    return current;
+}
+
+int Inventory::count(Texture t) const
+{
+    return t == EMPTY ? 0 : counts[t];
+}
@@ -0,0 +1,27 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include <scene/texture.h>
+
+// Blocks the player has mined and can place again, one slot per block type, and the type the
+// next placed block will be
+class Inventory
+{
+public:
+    static const int SLOTS = EMPTY;     // every Texture but EMPTY
+
+    Inventory();
+
+    // Removes one block of the selected type; EMPTY if there are none left
+    Texture take();
+    void give(Texture t);
+    void select(Texture t);
+    Texture selected() const;
+    int count(Texture t) const;
+
+private:
+    int counts[SLOTS];
+    Texture current;
+};
+
+#endif // INVENTORY_H
@@ -0,0 +1,159 @@
+#include "meshdata.h"
+#include <scene/blocks.h>
+
+qint64 MeshData::bytes() const
+{
+    return vertices.capacity() * sizeof(ChunkVertex) + indices.capacity() * sizeof(quint32)
+            + faces.capacity() * sizeof(quint32) + part_ends.capacity() * sizeof(int);
+}
+
+// Step to the neighbouring cell in each ChunkFace direction
+static const int FACE_OFFSETS[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+// Corners of each face relative to its cell, counter-clockwise seen from outside, and the
+// corner of the tile each one maps to. Must match the tables in chunkface.vert.glsl
+static const int FACE_CORNERS[6][4][3] = {
+    {{1, 1, 0}, {1, 0, 0}, {1, 0, 1}, {1, 1, 1}},
+    {{0, 1, 1}, {0, 0, 1}, {0, 0, 0}, {0, 1, 0}},
+    {{1, 1, 0}, {1, 1, 1}, {0, 1, 1}, {0, 1, 0}},
+    {{1, 0, 1}, {1, 0, 0}, {0, 0, 0}, {0, 0, 1}},
+    {{1, 1, 1}, {1, 0, 1}, {0, 0, 1}, {0, 1, 1}},
+    {{0, 1, 0}, {0, 0, 0}, {1, 0, 0}, {1, 1, 0}}
+};
+static const int TILE_CORNERS[4][2] = {{1, 0}, {1, 1}, {0, 1}, {0, 0}};
+
+// Faces on the grid's border are always visible, so every chunk mesh is closed. Inside it, a
+// face shows through any neighbour that isn't opaque, such as the lakebed under water, but
+// not between two cells of the same see-through block
+static bool faceVisible(const CellGrid &grid, int x, int y, int z, int face, Texture t)
+{
+    int size = grid.size();
+    int nx = x + FACE_OFFSETS[face][0], ny = y + FACE_OFFSETS[face][1], nz = z + FACE_OFFSETS[face][2];
+    if (nx < 0 || ny < 0 || nz < 0 || nx == size || ny == size || nz == size) {
+        return true;
+    }
+    Texture neighbour = grid.at(nx).at(ny).at(nz);
+    return !blockOpaque(neighbour) && neighbour != t;
+}
+
+// Appends the four corners of one face of the cell at x, y, z
+static void appendQuad(QVector<ChunkVertex> &quads, int x, int y, int z, int face, Texture t)
+{
+    const BlockInfo &block = BLOCKS[t];
+    ChunkVertex v;
+    v.nor = glm::vec3(FACE_OFFSETS[face][0], FACE_OFFSETS[face][1], FACE_OFFSETS[face][2]);
+    v.layer = block.tiles[face];
+    v.flags = block.flags;
+    v.slot = 0;
+    for (int k = 0; k < 4; k++) {
+        const int *c = FACE_CORNERS[face][k];
+        v.pos = glm::vec3(x + c[0], y + c[1], z + c[2]);
+        v.u = TILE_CORNERS[k][0];
+        v.v = TILE_CORNERS[k][1];
+        quads.append(v);
+    }
+}
+
+// Two triangles per quad of mesh.vertices
+static void indexQuads(MeshData &mesh)
+{
+    int quads = mesh.vertices.size() / 4;
+    mesh.indices.resize(quads * 6);
+    for (int i = 0; i < quads; i++) {
+        quint32 *quad = mesh.indices.data() + i * 6;
+        quad[0] = i*4;
+        quad[1] = i*4 + 1;
+        quad[2] = i*4 + 2;
+        quad[3] = i*4;
+        quad[4] = i*4 + 2;
+        quad[5] = i*4 + 3;
+    }
+}
+
+/**
+ * @brief MeshData::buildVertices - meshes a cubic grid of cells, in units of the grid's cells
+ * Faces on the grid's border are always emitted, so every chunk mesh is closed. That keeps
+ * neighbours drawn at different levels of detail from showing cracks between them.
+ * The indices are grouped into mesh parts, by pass and then by the direction faces point.
+ * Only reads its arguments, so it is safe to call from worker threads.
+ */
+void MeshData::buildVertices(const CellGrid &grid, MeshData &mesh)
+{
+    int size = grid.size();
+    QVector<ChunkVertex> parts[MESH_PARTS];
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            for (int z = 0; z < size; z++) {
+                Texture t = grid.at(x).at(y).at(z);
+                if (t == EMPTY) {
+                    continue;
+                }
+                int pass = blockOpaque(t) ? PASS_OPAQUE : PASS_TRANSLUCENT;
+                for (int face = 0; face < 6; face++) {
+                    if (faceVisible(grid, x, y, z, face, t)) {
+                        appendQuad(parts[meshPart(pass, face)], x, y, z, face, t);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int part = 0; part < MESH_PARTS; part++) {
+        mesh.vertices += parts[part];
+        mesh.part_ends.append(mesh.vertices.size() / 4 * 6);
+    }
+    indexQuads(mesh);
+}
+
+/**
+ * @brief MeshData::buildFaces - meshes a cubic grid of cells as one packed record per visible face
+ * Emits the same faces as buildVertices, grouped into the same mesh parts, but each face is a
+ * single 32-bit word the vertex shader expands into two triangles. See packFace.
+ */
+void MeshData::buildFaces(const CellGrid &grid, MeshData &mesh)
+{
+    int size = grid.size();
+    QVector<quint32> parts[MESH_PARTS];
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            for (int z = 0; z < size; z++) {
+                Texture t = grid.at(x).at(y).at(z);
+                if (t == EMPTY) {
+                    continue;
+                }
+                int pass = blockOpaque(t) ? PASS_OPAQUE : PASS_TRANSLUCENT;
+                for (int face = 0; face < 6; face++) {
+                    if (faceVisible(grid, x, y, z, face, t)) {
+                        parts[meshPart(pass, face)].append(packFace(x, y, z, face, t));
+                    }
+                }
+            }
+        }
+    }
+    for (int part = 0; part < MESH_PARTS; part++) {
+        mesh.faces += parts[part];
+        mesh.part_ends.append(mesh.faces.size());
+    }
+}
+
+/**
+ * @brief MeshData::unpackFaces - replaces a mesh's packed faces with indexed vertices
+ * The result is what buildVertices makes of the same cells: faces stay in order, so the mesh
+ * parts keep their bounds, counted in indices instead of faces.
+ */
+void MeshData::unpackFaces(MeshData &mesh)
+{
+    mesh.vertices.clear();
+    mesh.vertices.reserve(mesh.faces.size() * 4);
+    for (quint32 record : mesh.faces) {
+        int face = (record >> 12) & 7;
+        Texture t = (Texture) ((record >> FACE_BLOCK_SHIFT) & (MAX_FACE_BLOCKS - 1));
+        appendQuad(mesh.vertices, record & 15, (record >> 4) & 15, (record >> 8) & 15, face, t);
+    }
+    indexQuads(mesh);
+    for (int &end : mesh.part_ends) {
+        end *= 6;
+    }
+    mesh.faces.clear();
+    mesh.faces.squeeze();
+}
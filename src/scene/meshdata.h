@@ -0,0 +1,61 @@
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include <scene/chunkdata.h>
+#include <la.h>
+#include <QVector>
+
+// Chunk meshes are drawn in two passes; opaque faces first, then water and lava
+enum MeshPass {
+    PASS_OPAQUE = 0, PASS_TRANSLUCENT, MESH_PASSES
+};
+
+// The indices of every chunk mesh are grouped into consecutive parts, one per pass and
+// ChunkFace, so a draw can pick a pass and leave out directions facing away from the camera
+static const int MESH_PARTS = MESH_PASSES * 6;
+inline int meshPart(int pass, int face) { return pass * 6 + face; }
+
+// Vertex layout shared by every chunk mesh stored in the arena
+struct ChunkVertex {
+    glm::vec3 pos;      // relative to the chunk's origin
+    glm::vec3 nor;
+    quint8 u, v;        // corner of the tile, 0 or 1
+    quint8 layer;       // layer of the block tile array, see TileArray
+    quint8 flags;       // the block's BlockFlag bits
+    float slot;         // row of the chunk origin buffer, written by ChunkArena::upload
+};
+
+// Packed face record for vertex pulling: bits 0-11 hold the cell's x, y and z (4 bits each),
+// 12-14 the ChunkFace, 15-18 the Texture and 19-31 the arena slot, which ChunkArena::upload
+// fills in. Unpacked by chunkface.vert.glsl, which looks the block up in the registry tables
+// ShaderProgram uploads.
+static const int FACE_BLOCK_SHIFT = 15;
+static const int FACE_SLOT_SHIFT = 19;
+// Block types a face record has room for, EMPTY included
+static const int MAX_FACE_BLOCKS = 1 << (FACE_SLOT_SHIFT - FACE_BLOCK_SHIFT);
+// Arena slots a face record has room for; a mesh in any other slot has to be indexed
+static const int MAX_FACE_SLOTS = 1 << (32 - FACE_SLOT_SHIFT);
+inline quint32 packFace(int x, int y, int z, int face, int texture)
+{
+    return x | (y << 4) | (z << 8) | (face << 12) | (texture << FACE_BLOCK_SHIFT);
+}
+
+// A chunk mesh on the CPU in either of the formats the arena stores: indexed vertices, or one
+// packed record per face. part_ends splits it into consecutive parts that can be drawn
+// separately, counted in indices or in faces respectively. Building one needs no GL context.
+struct MeshData {
+    QVector<ChunkVertex> vertices;
+    QVector<quint32> indices;
+    QVector<quint32> faces;
+    QVector<int> part_ends;
+
+    // Estimate of the memory held, from the capacities of the vectors
+    qint64 bytes() const;
+
+    static void buildVertices(const CellGrid &grid, MeshData &mesh);
+    static void buildFaces(const CellGrid &grid, MeshData &mesh);
+    // Turns a mesh of packed faces into the same mesh as indexed vertices
+    static void unpackFaces(MeshData &mesh);
+};
+
+#endif // MESHDATA_H
@@ -0,0 +1,192 @@
+#include "occlusion.h"
+#include <math.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define OCCLUSION_SSE
+#endif
+
+const int OcclusionBuffer::WIDTH;
+const int OcclusionBuffer::HEIGHT;
+
+// Vertices closer than this (in clip w) are treated as crossing the near plane
+static const float MIN_W = 0.01f;
+
+OcclusionBuffer::OcclusionBuffer()
+{
+    clear(glm::mat4(1.f), glm::vec3(0));
+}
+
+void OcclusionBuffer::clear(const glm::mat4 &viewproj, const glm::vec3 &eye)
+{
+    this->viewproj = viewproj;
+    this->eye = eye;
+    for (int i = 0; i < WIDTH * HEIGHT + 4; i++) {
+        depth[i] = 1.f;
+    }
+}
+
+// Clip space to buffer pixels; z stays in NDC
+glm::vec3 OcclusionBuffer::toScreen(const glm::vec4 &clip) const
+{
+    return glm::vec3((clip.x / clip.w * 0.5f + 0.5f) * WIDTH,
+                     (clip.y / clip.w * 0.5f + 0.5f) * HEIGHT,
+                     clip.z / clip.w);
+}
+
+void OcclusionBuffer::addOccluder(const glm::vec3 &bmin, const glm::vec3 &bmax)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        for (int side = 0; side < 2; side++) {
+            // Only the sides facing the eye can be seen
+            float plane = side ? bmax[axis] : bmin[axis];
+            if (side ? eye[axis] <= plane : eye[axis] >= plane) {
+                continue;
+            }
+            glm::vec3 screen[4];
+            bool behind = false;
+            for (int i = 0; i < 4; i++) {
+                glm::vec3 corner;
+                corner[axis] = plane;
+                corner[u] = (i == 1 || i == 2) ? bmax[u] : bmin[u];
+                corner[v] = (i >= 2) ? bmax[v] : bmin[v];
+                glm::vec4 clip = viewproj * glm::vec4(corner, 1);
+                behind = behind || clip.w < MIN_W;
+                screen[i] = toScreen(clip);
+            }
+            // Faces cut by the near plane are skipped rather than clipped;
+            // leaving an occluder out is always safe
+            if (!behind) {
+                rasterizeQuad(screen);
+            }
+        }
+    }
+}
+
+/**
+ * @brief OcclusionBuffer::rasterizeQuad - writes a convex screen space quad into the buffer
+ * Pixels are only written when the quad covers them entirely, and with the largest depth the
+ * quad has inside the pixel, so the buffer never claims more occlusion than really exists.
+ * @param v - the corners in pixels, with NDC depth in z
+ */
+void OcclusionBuffer::rasterizeQuad(const glm::vec3 v[4])
+{
+    float area = 0;
+    glm::vec2 lo = glm::vec2(v[0]), hi = glm::vec2(v[0]);
+    for (int i = 0; i < 4; i++) {
+        const glm::vec3 &a = v[i], &b = v[(i + 1) % 4];
+        area += a.x * b.y - b.x * a.y;
+        lo = glm::min(lo, glm::vec2(a));
+        hi = glm::max(hi, glm::vec2(a));
+    }
+    if (fabs(area) < 1e-6f) {
+        return;
+    }
+
+    // Edge functions A*x + B*y + C, positive inside regardless of winding. A pixel is
+    // fully inside an edge when the value at its center exceeds half its extent.
+    float sign = area > 0 ? 1.f : -1.f;
+    float ea[4], eb[4], ec[4], thr[4];
+    for (int i = 0; i < 4; i++) {
+        const glm::vec3 &a = v[i], &b = v[(i + 1) % 4];
+        ea[i] = -(b.y - a.y) * sign;
+        eb[i] = (b.x - a.x) * sign;
+        ec[i] = -(ea[i] * a.x + eb[i] * a.y);
+        thr[i] = 0.5f * (fabs(ea[i]) + fabs(eb[i]));
+    }
+
+    // Depth is affine in screen space for a planar quad; bias it to the far side of the pixel
+    glm::vec3 d1 = v[1] - v[0], d2 = v[2] - v[0];
+    float det = d1.x * d2.y - d2.x * d1.y;
+    if (fabs(det) < 1e-6f) {
+        return;
+    }
+    float za = (d1.z * d2.y - d2.z * d1.y) / det;
+    float zb = (d2.z * d1.x - d1.z * d2.x) / det;
+    float zc = v[0].z - za * v[0].x - zb * v[0].y + 0.5f * (fabs(za) + fabs(zb));
+
+    int x0 = glm::max(0, (int) floor(lo.x)) & ~3;
+    int x1 = glm::min(WIDTH - 1, (int) floor(hi.x));
+    int y0 = glm::max(0, (int) floor(lo.y));
+    int y1 = glm::min(HEIGHT - 1, (int) floor(hi.y));
+
+    for (int y = y0; y <= y1; y++) {
+        float py = y + 0.5f;
+        for (int x = x0; x <= x1; x += 4) {
+            float *row = depth + y * WIDTH + x;
+#ifdef OCCLUSION_SSE
+            __m128 px = _mm_add_ps(_mm_set1_ps((float) x), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+            __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+            for (int i = 0; i < 4; i++) {
+                __m128 e = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[i]), px), _mm_set1_ps(eb[i] * py + ec[i]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(e, _mm_set1_ps(thr[i])));
+            }
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), px), _mm_set1_ps(zb * py + zc));
+            __m128 old = _mm_loadu_ps(row);
+            __m128 closer = _mm_min_ps(old, z);
+            _mm_storeu_ps(row, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, old)));
+#else
+            for (int k = 0; k < 4; k++) {
+                float px = x + k + 0.5f;
+                bool inside = true;
+                for (int i = 0; i < 4; i++) {
+                    inside = inside && ea[i] * px + eb[i] * py + ec[i] >= thr[i];
+                }
+                if (inside) {
+                    row[k] = fmin(row[k], za * px + zb * py + zc);
+                }
+            }
+#endif
+        }
+    }
+}
+
+bool OcclusionBuffer::isOccluded(const glm::vec3 &bmin, const glm::vec3 &bmax) const
+{
+    glm::vec2 lo = glm::vec2(INFINITY), hi = glm::vec2(-INFINITY);
+    float nearest = INFINITY;
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner = glm::vec3(i & 4 ? bmax.x : bmin.x,
+                                     i & 2 ? bmax.y : bmin.y,
+                                     i & 1 ? bmax.z : bmin.z);
+        glm::vec4 clip = viewproj * glm::vec4(corner, 1);
+        if (clip.w < MIN_W) {
+            return false;   // reaches behind the camera, assume visible
+        }
+        glm::vec3 screen = toScreen(clip);
+        lo = glm::min(lo, glm::vec2(screen));
+        hi = glm::max(hi, glm::vec2(screen));
+        nearest = fmin(nearest, screen.z);
+    }
+
+    int x0 = glm::max(0, (int) floor(lo.x));
+    int x1 = glm::min(WIDTH - 1, (int) floor(hi.x));
+    int y0 = glm::max(0, (int) floor(lo.y));
+    int y1 = glm::min(HEIGHT - 1, (int) floor(hi.y));
+    if (x0 > x1 || y0 > y1) {
+        return false;
+    }
+
+    for (int y = y0; y <= y1; y++) {
+        const float *row = depth + y * WIDTH;
+        for (int x = x0; x <= x1; x += 4) {
+            int count = glm::min(4, x1 - x + 1);
+#ifdef OCCLUSION_SSE
+            // The buffer is padded so reading past the end of the last row is safe
+            __m128 behind = _mm_cmpge_ps(_mm_loadu_ps(row + x), _mm_set1_ps(nearest));
+            if (_mm_movemask_ps(behind) & ((1 << count) - 1)) {
+                return false;
+            }
+#else
+            for (int k = 0; k < count; k++) {
+                if (row[x + k] >= nearest) {
+                    return false;
+                }
+            }
+#endif
+        }
+    }
+    return true;
+}
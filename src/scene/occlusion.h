@@ -0,0 +1,34 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <la.h>
+
+// A small CPU depth buffer for coarse occlusion culling.
+// Solid boxes near the camera are rasterized into it conservatively (a pixel is only
+// written if the box covers all of it, with the farthest depth under the pixel), then
+// other boxes are tested against it before they are submitted to OpenGL.
+class OcclusionBuffer
+{
+public:
+    static const int WIDTH = 128;
+    static const int HEIGHT = 64;
+
+    OcclusionBuffer();
+
+    // Empties the buffer and sets the view used by the following calls
+    void clear(const glm::mat4 &viewproj, const glm::vec3 &eye);
+    // Rasterizes the camera-facing sides of a box that is completely solid
+    void addOccluder(const glm::vec3 &bmin, const glm::vec3 &bmax);
+    // True if every pixel the box could cover is already closer than the box
+    bool isOccluded(const glm::vec3 &bmin, const glm::vec3 &bmax) const;
+
+private:
+    glm::mat4 viewproj;
+    glm::vec3 eye;
+    float depth[WIDTH * HEIGHT + 4];    // NDC depth, 1 is the far plane; padded for 4-wide reads
+
+    glm::vec3 toScreen(const glm::vec4 &clip) const;
+    void rasterizeQuad(const glm::vec3 v[4]);
+};
+
+#endif // OCCLUSION_H
@@ -1,4 +1,6 @@
 #include "octnode.h"
+#include <trace.h>
+#include <memorystats.h>
 struct sort_pred {
     bool operator()(const std::pair<float,OctNode*> &left, const std::pair<float,OctNode*> &right) {
         return left.first < right.first;
@@ -20,18 +22,27 @@ Octree subdivides in this order:
 // +z is toward you!
 // base point = "bottom left" of octnode
 OctNode::OctNode(Point3 base, int length) : base(base), length(length), is_leaf(true), chunk(nullptr)
-{}
+{
+    MemoryStats::add(MEM_OCTREE, sizeof(OctNode), 1);
+}
 
 OctNode::~OctNode()
 {
+    MemoryStats::add(MEM_OCTREE, -(qint64) sizeof(OctNode), -1);
     for (OctNode* child : children) {
         delete child;
     }
 }
 
-void OctNode::setChunk(Chunk* new_chunk) {
-    delete this->chunk;
+void OctNode::setChunk(ChunkData* new_chunk) {
+    if (this->chunk) {
+        Trace::instant("evict", "chunk", base.x, base.y, base.z);
+        ChunkData::evict(this->chunk);
+    }
     this->chunk = new_chunk;
+    if (new_chunk) {
+        new_chunk->cell = glm::ivec3(base.x, base.y, base.z);
+    }
 }
 
 // Returns the quadrant (0-7) containing the point
@@ -1,7 +1,7 @@
 #ifndef OCTNODE_H
 #define OCTNODE_H
 
-#include "geometry/chunk.h"
+#include "chunkdata.h"
 #include "point3.h"
 #include "ray.h"
 #include "intersection.h"
@@ -15,7 +15,7 @@ public:
     int length;     // in chunks
     Point3 base;    // the smallest x, y, and z coordinates of the node
     QList<OctNode*> children;
-    Chunk* chunk;   // null unless is_leaf == true
+    ChunkData* chunk;   // null unless is_leaf == true
     Intersection intersect;
 
     OctNode* getContainingNode(Point3 p);
@@ -24,7 +24,7 @@ public:
     OctNode* rayCastOct(Ray ray);
     Intersection findIntersection(Ray ray, float minx, float maxx, float miny, float maxy, float minz, float maxz);
     bool nearlyEqual(float a, float b);
-    void setChunk(Chunk* new_chunk);
+    void setChunk(ChunkData* new_chunk);
 };
 
 #endif // OCTNODE_H
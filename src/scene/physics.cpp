@@ -0,0 +1,118 @@
+#include "physics.h"
+#include <scene/scene.h>
+
+const float PlayerPhysics::TIMESTEP = 1.f / 60.f;
+
+// Player box relative to the eye, in blocks
+static const float HALF_WIDTH = 0.3f;
+static const float FEET = 1.5f;
+static const float HEAD = 0.3f;
+// Keeps the box from resting exactly on a block boundary
+static const float SKIN = 0.001f;
+
+static const float GRAVITY = 11.1f;
+static const float TERMINAL_VELOCITY = 50.f;
+static const float JUMP_SPEED = 6.f;
+
+PlayerPhysics::PlayerPhysics() : on_ground(false)
+{}
+
+void PlayerPhysics::teleport(const glm::vec3 &eye)
+{
+    position = eye;
+    previous_position = eye;
+    velocity = glm::vec3(0);
+    on_ground = false;
+}
+
+glm::vec3 PlayerPhysics::boxMin() const
+{
+    return position - glm::vec3(HALF_WIDTH, FEET, HALF_WIDTH);
+}
+
+glm::vec3 PlayerPhysics::boxMax() const
+{
+    return position + glm::vec3(HALF_WIDTH, HEAD, HALF_WIDTH);
+}
+
+/**
+ * @brief PlayerPhysics::sweepAxis - moves the box along one axis until it touches a block
+ * Only the layers of cells the leading face passes through are checked, so the box can
+ * never skip over a block however far it moves in one step.
+ * @param scene - the world to collide against
+ * @param axis - 0, 1 or 2 for x, y or z
+ * @param amount - the signed distance to move
+ * @return the signed distance that can actually be moved
+ */
+float PlayerPhysics::sweepAxis(const Scene &scene, int axis, float amount) const
+{
+    if (amount == 0) {
+        return 0;
+    }
+    glm::vec3 bmin = boxMin();
+    glm::vec3 bmax = boxMax();
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+    int u0 = glm::floor(bmin[u] + SKIN), u1 = glm::floor(bmax[u] - SKIN);
+    int v0 = glm::floor(bmin[v] + SKIN), v1 = glm::floor(bmax[v] - SKIN);
+
+    float lead = amount > 0 ? bmax[axis] : bmin[axis];
+    int dir = amount > 0 ? 1 : -1;
+    // First layer of cells outside the box, then every layer up to where the face ends
+    int first = amount > 0 ? (int) glm::floor(lead - SKIN) + 1 : (int) glm::floor(lead + SKIN) - 1;
+    int last = glm::floor(lead + amount);
+
+    for (int layer = first; dir * (last - layer) >= 0; layer += dir) {
+        for (int a = u0; a <= u1; a++) {
+            for (int b = v0; b <= v1; b++) {
+                glm::ivec3 cell;
+                cell[axis] = layer;
+                cell[u] = a;
+                cell[v] = b;
+                if (scene.getBlock(cell.x, cell.y, cell.z) != EMPTY) {
+                    // Stop just short of the block's near face
+                    float face = amount > 0 ? layer : layer + 1;
+                    float allowed = face - lead - dir * SKIN;
+                    return dir * allowed > 0 ? allowed : 0;
+                }
+            }
+        }
+    }
+    return amount;
+}
+
+void PlayerPhysics::step(const Scene &scene, const glm::vec3 &wish, bool gravity, bool jump)
+{
+    previous_position = position;
+
+    velocity.x = wish.x;
+    velocity.z = wish.z;
+    if (gravity) {
+        if (jump && on_ground) {
+            velocity.y = JUMP_SPEED;
+        }
+        velocity.y = glm::max(velocity.y - GRAVITY * TIMESTEP, -TERMINAL_VELOCITY);
+    } else {
+        velocity.y = wish.y;
+    }
+
+    // Resolve vertical motion first so walking off ledges and landing behave
+    glm::vec3 delta = velocity * TIMESTEP;
+    for (int axis : {1, 0, 2}) {
+        float moved = sweepAxis(scene, axis, delta[axis]);
+        position[axis] += moved;
+        if (moved != delta[axis]) {
+            if (axis == 1 && delta.y < 0) {
+                on_ground = true;
+            }
+            velocity[axis] = 0;
+        } else if (axis == 1 && delta.y != 0) {
+            on_ground = false;
+        }
+    }
+}
+
+glm::vec3 PlayerPhysics::interpolate(float alpha) const
+{
+    return glm::mix(previous_position, position, alpha);
+}
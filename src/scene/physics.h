@@ -0,0 +1,36 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <la.h>
+
+class Scene;
+
+// Simulates the player's bounding box against the voxel grid.
+// step() always advances by TIMESTEP seconds; the caller accumulates real time
+// and interpolates between the last two states for rendering.
+class PlayerPhysics
+{
+public:
+    PlayerPhysics();
+
+    static const float TIMESTEP;
+
+    glm::vec3 position;             // eye position after the latest step
+    glm::vec3 previous_position;    // eye position before the latest step
+    glm::vec3 velocity;
+    bool on_ground;
+
+    // Places the player without sweeping, e.g. when gravity is switched on
+    void teleport(const glm::vec3 &eye);
+    // wish is the desired horizontal velocity in blocks/second
+    void step(const Scene &scene, const glm::vec3 &wish, bool gravity, bool jump);
+    // alpha in [0, 1] blends from previous_position to position
+    glm::vec3 interpolate(float alpha) const;
+
+private:
+    glm::vec3 boxMin() const;
+    glm::vec3 boxMax() const;
+    float sweepAxis(const Scene &scene, int axis, float amount) const;
+};
+
+#endif // PHYSICS_H
@@ -0,0 +1,222 @@
+#include "raybatch.h"
+#include <scene/scene.h>
+#include <scene/octnode.h>
+#include <jobs.h>
+#include <trace.h>
+#include <math.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RAYBATCH_SSE
+#endif
+
+static const int PACKET_SIZE = 4;
+static const int PACKETS_PER_JOB = 64;
+static const int MIN_PARALLEL_RAYS = 1024;
+
+// Four rays in SoA layout so the slab tests can run on all of them at once
+struct RayPacket {
+    float ox[PACKET_SIZE], oy[PACKET_SIZE], oz[PACKET_SIZE];
+    float ix[PACKET_SIZE], iy[PACKET_SIZE], iz[PACKET_SIZE];   // reciprocal directions
+    float best[PACKET_SIZE];    // closest hit found so far, max_t if nothing was hit
+    int count;
+    int order;                  // child visiting order, see traversePacket
+};
+
+// Zero direction components would give 0 * inf in the slab test
+static float safeInverse(float d)
+{
+    if (fabs(d) < 1e-8f) {
+        d = d < 0 ? -1e-8f : 1e-8f;
+    }
+    return 1.f / d;
+}
+
+/**
+ * @brief slabTest - intersects every ray of the packet with an axis aligned box
+ * @param p - the packet to test
+ * @param bmin - smallest corner of the box
+ * @param bmax - largest corner of the box
+ * @return a bitmask of the rays that enter the box before their current best hit
+ */
+static int slabTest(const RayPacket &p, const float bmin[3], const float bmax[3])
+{
+#ifdef RAYBATCH_SSE
+    __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[0]), _mm_loadu_ps(p.ox)), _mm_loadu_ps(p.ix));
+    __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[0]), _mm_loadu_ps(p.ox)), _mm_loadu_ps(p.ix));
+    __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[1]), _mm_loadu_ps(p.oy)), _mm_loadu_ps(p.iy));
+    __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[1]), _mm_loadu_ps(p.oy)), _mm_loadu_ps(p.iy));
+    __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[2]), _mm_loadu_ps(p.oz)), _mm_loadu_ps(p.iz));
+    __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[2]), _mm_loadu_ps(p.oz)), _mm_loadu_ps(p.iz));
+
+    __m128 t_near = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+                               _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+    __m128 t_far = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+                              _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_loadu_ps(p.best)));
+    return _mm_movemask_ps(_mm_cmple_ps(t_near, t_far)) & ((1 << p.count) - 1);
+#else
+    int mask = 0;
+    for (int i = 0; i < p.count; i++) {
+        float t0x = (bmin[0] - p.ox[i]) * p.ix[i], t1x = (bmax[0] - p.ox[i]) * p.ix[i];
+        float t0y = (bmin[1] - p.oy[i]) * p.iy[i], t1y = (bmax[1] - p.oy[i]) * p.iy[i];
+        float t0z = (bmin[2] - p.oz[i]) * p.iz[i], t1z = (bmax[2] - p.oz[i]) * p.iz[i];
+        float t_near = fmax(fmax(fmin(t0x, t1x), fmin(t0y, t1y)), fmax(fmin(t0z, t1z), 0.f));
+        float t_far = fmin(fmin(fmax(t0x, t1x), fmax(t0y, t1y)), fmin(fmax(t0z, t1z), p.best[i]));
+        if (t_near <= t_far) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief marchChunk - walks a single ray through the cells of a chunk (Amanatides & Woo)
+ * @param chunk - the chunk to march through
+ * @param base - the chunk's octree base coordinate (in chunks)
+ * @param ray - the ray to march
+ * @param hit - updated if a block closer than hit.t is found
+ */
+static void marchChunk(const ChunkData *chunk, const Point3 &base, const Ray &ray, RayHit &hit)
+{
+    glm::vec3 bmin = glm::vec3(base.x, base.y, base.z) * 16.f;
+    glm::vec3 bmax = bmin + glm::vec3(16.f);
+    const glm::vec3 &o = ray.origin;
+    const glm::vec3 &d = ray.direction;
+
+    // Find where the ray enters the chunk and through which face
+    float t_enter = 0.f;
+    int axis = -1;
+    for (int a = 0; a < 3; a++) {
+        float face = d[a] >= 0 ? bmin[a] : bmax[a];
+        float t = (face - o[a]) * safeInverse(d[a]);
+        if (t > t_enter) {
+            t_enter = t;
+            axis = a;
+        }
+    }
+
+    glm::vec3 p = o + d * t_enter - bmin;
+    glm::ivec3 cell = glm::clamp(glm::ivec3(glm::floor(p)), glm::ivec3(0), glm::ivec3(15));
+    glm::ivec3 step;
+    glm::vec3 t_max, t_delta;
+    for (int a = 0; a < 3; a++) {
+        float inv = safeInverse(d[a]);
+        step[a] = d[a] >= 0 ? 1 : -1;
+        float boundary = d[a] >= 0 ? cell[a] + 1 : cell[a];
+        t_max[a] = t_enter + (boundary - p[a]) * inv;
+        t_delta[a] = fabs(inv);
+    }
+
+    float t = t_enter;
+    while (t < hit.t) {
+        if (chunk->cells.at(cell.x).at(cell.y).at(cell.z) != EMPTY) {
+            hit.hit = true;
+            hit.t = t;
+            hit.block = Point3(bmin.x + cell.x, bmin.y + cell.y, bmin.z + cell.z);
+            hit.normal = glm::vec3(0);
+            if (axis != -1) {
+                hit.normal[axis] = -step[axis];
+            }
+            return;
+        }
+        axis = 0;
+        if (t_max[1] < t_max[axis]) axis = 1;
+        if (t_max[2] < t_max[axis]) axis = 2;
+        t = t_max[axis];
+        cell[axis] += step[axis];
+        t_max[axis] += t_delta[axis];
+        if (cell[axis] < 0 || cell[axis] > 15) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief traversePacket - recursively visits every octree node hit by at least one ray of the packet
+ * @param node - the node to test
+ * @param packet - the packet being traced; its best hits are tightened as blocks are found
+ * @param rays - the rays of the packet
+ * @param hits - the hits of the packet
+ * @param mask - the rays that are still alive
+ */
+static void traversePacket(const OctNode *node, RayPacket &packet, const Ray *rays, RayHit *hits, int mask)
+{
+    float bmin[3] = {node->base.x * 16.f, node->base.y * 16.f, node->base.z * 16.f};
+    float bmax[3] = {(node->base.x + node->length) * 16.f,
+                     (node->base.y + node->length) * 16.f,
+                     (node->base.z + node->length) * 16.f};
+    mask &= slabTest(packet, bmin, bmax);
+    if (!mask) {
+        return;
+    }
+
+    if (node->is_leaf) {
+        const ChunkData *chunk = node->chunk;
+        // Unbuilt subtrees and chunks without any blocks can never be hit
+        if (!chunk || node->length != 1 || chunk->block_count == 0) {
+            return;
+        }
+        for (int i = 0; i < packet.count; i++) {
+            if (mask & (1 << i)) {
+                marchChunk(chunk, node->base, rays[i], hits[i]);
+                packet.best[i] = hits[i].t;
+            }
+        }
+        return;
+    }
+
+    // Children are numbered x*4 + y*2 + z (see OctNode::buildTree), so flipping the
+    // bits of the negative direction axes visits them front to back for the packet
+    for (int i = 0; i < 8; i++) {
+        traversePacket(node->children.at(i ^ packet.order), packet, rays, hits, mask);
+    }
+}
+
+void RayBatch::castRange(const OctNode *root, const Ray *rays, RayHit *hits, int count, float max_t)
+{
+    for (int first = 0; first < count; first += PACKET_SIZE) {
+        RayPacket packet;
+        packet.count = qMin(PACKET_SIZE, count - first);
+        for (int i = 0; i < PACKET_SIZE; i++) {
+            // Pad the last packet with copies of its first ray; they are masked out anyway
+            const Ray &ray = rays[first + (i < packet.count ? i : 0)];
+            packet.ox[i] = ray.origin.x;
+            packet.oy[i] = ray.origin.y;
+            packet.oz[i] = ray.origin.z;
+            packet.ix[i] = safeInverse(ray.direction.x);
+            packet.iy[i] = safeInverse(ray.direction.y);
+            packet.iz[i] = safeInverse(ray.direction.z);
+            packet.best[i] = max_t;
+        }
+        for (int i = 0; i < packet.count; i++) {
+            hits[first + i].hit = false;
+            hits[first + i].t = max_t;
+            hits[first + i].block = Point3();
+            hits[first + i].normal = glm::vec3(0);
+        }
+        const glm::vec3 &d = rays[first].direction;
+        packet.order = (d.x < 0 ? 4 : 0) | (d.y < 0 ? 2 : 0) | (d.z < 0 ? 1 : 0);
+        traversePacket(root, packet, rays + first, hits + first, (1 << packet.count) - 1);
+    }
+}
+
+QVector<RayHit> RayBatch::cast(const Scene &scene, const QVector<Ray> &rays, float max_t)
+{
+    TraceScope trace("ray batch", "ray");
+    QVector<RayHit> hits(rays.size());
+    const Ray *ray_data = rays.constData();
+    RayHit *hit_data = hits.data();
+    const OctNode *root = scene.octree;
+
+    if (rays.size() < MIN_PARALLEL_RAYS) {
+        castRange(root, ray_data, hit_data, rays.size(), max_t);
+        return hits;
+    }
+
+    // The octree is only read here, so jobs can share it without locking
+    JobSystem::parallelFor(rays.size(), PACKET_SIZE * PACKETS_PER_JOB, [=](int first, int end) {
+        castRange(root, ray_data + first, hit_data + first, end - first, max_t);
+    });
+    return hits;
+}
@@ -0,0 +1,32 @@
+#ifndef RAYBATCH_H
+#define RAYBATCH_H
+
+#include <QVector>
+#include "ray.h"
+#include "point3.h"
+
+class Scene;
+class OctNode;
+
+// Result of casting one ray into the voxel world
+struct RayHit {
+    bool hit;
+    float t;            // distance along the ray to the hit block
+    Point3 block;       // world coordinates of the hit block (INFINITY if missed)
+    glm::vec3 normal;   // normal of the face the ray entered through
+};
+
+// Casts many rays against the octree at once. Rays are grouped into packets of four
+// which are slab tested against the octree node bounds together using SIMD, and each
+// packet only marches through the voxels of chunks that actually contain blocks.
+// Large batches are spread across the job system.
+class RayBatch
+{
+public:
+    static QVector<RayHit> cast(const Scene &scene, const QVector<Ray> &rays, float max_t = 32.f);
+
+private:
+    static void castRange(const OctNode *root, const Ray *rays, RayHit *hits, int count, float max_t);
+};
+
+#endif // RAYBATCH_H
@@ -1,14 +1,18 @@
 #include <scene/scene.h>
-#include <scene/geometry/cube.h>
-#include <scene/geometry/chunk.h>
+#include <scene/blocks.h>
+#include <profiler.h>
+#include <trace.h>
+#include <jobs.h>
 #include <iostream>
 
-#define MAX_TERRAIN_HEIGHT 6    // Fix dis; make # of y_chunks generated dependent on Perlin noise height
 static const int SCENE_DIM = 80;
 static const int TERRAIN_DIM = 80;
+// Branches of an L-system structure rasterized per job
+static const int LINES_PER_JOB = 64;
 
 // Dimensions must be a multiple of 16
-Scene::Scene() : dimensions(SCENE_DIM, SCENE_DIM, SCENE_DIM), terrain(TERRAIN_DIM, TERRAIN_DIM), num_chunks(SCENE_DIM/16), origin(glm::vec3(0, 0, 0))
+Scene::Scene() : dimensions(SCENE_DIM, SCENE_DIM, SCENE_DIM), terrain(TERRAIN_DIM, TERRAIN_DIM), num_chunks(SCENE_DIM/16), origin(glm::vec3(0, 0, 0)),
+    heightmap_memory(MEM_HEIGHTMAP)
 {
     /* The base coordinate centers the origin (0,0) on the x-z plane in the octree
        You can generate a maximum of 32 chunks in either direction, and 64 chunks upward */
@@ -32,8 +36,11 @@ void Scene::addVoxel(QSet<OctNode *> &set, Point3 &p) {
     chunk->chunk->cells[localPoint.x][localPoint.y][localPoint.z] = WOOD;
 }
 
-void Scene::bresenham(const glm::vec4 &p1, const glm::vec4 &p2) {
-    QSet<OctNode *> modifiedNodes;
+/**
+ * @brief Scene::rasterizeLine - appends the cells a 3D Bresenham line from p1 to p2 passes through
+ * Only reads its arguments, so lines can be rasterized on worker threads.
+ */
+void Scene::rasterizeLine(const glm::vec4 &p1, const glm::vec4 &p2, QVector<Point3> &cells) {
     Point3 p(p1.x, p1.y, p1.z);
     int dx = p2.x - p1.x;
     int dy = p2.y - p1.y;
@@ -52,7 +59,7 @@ void Scene::bresenham(const glm::vec4 &p1, const glm::vec4 &p2) {
         error_1 = dy_err - l;
         error_2 = dz_err - l;
         for (int i = 0; i < l; i++) {
-            addVoxel(modifiedNodes, p);
+            cells.append(p);
             // assign to point here
             if (error_1 > 0) {
                 p.y += yDir;
@@ -70,7 +77,7 @@ void Scene::bresenham(const glm::vec4 &p1, const glm::vec4 &p2) {
         error_1 = dy_err - m;
         error_2 = dz_err - m;
         for (int i = 0; i < m; i++) {
-            addVoxel(modifiedNodes, p);
+            cells.append(p);
             if (error_1 > 0) {
                 p.x += xDir;
                 error_1 -= dy_err;
@@ -87,7 +94,7 @@ void Scene::bresenham(const glm::vec4 &p1, const glm::vec4 &p2) {
         error_1 = dy_err - n;
         error_2 = dz_err - n;
         for (int i = 0; i < n; i++) {
-            addVoxel(modifiedNodes, p);
+            cells.append(p);
             if (error_1 > 0) {
                 p.y += yDir;
                 error_1 -= dz_err;
@@ -102,21 +109,51 @@ void Scene::bresenham(const glm::vec4 &p1, const glm::vec4 &p2) {
         }
     }
     // assign to point here
-    addVoxel(modifiedNodes, p);
+    cells.append(p);
+}
+
+void Scene::bresenham(const glm::vec4 &p1, const glm::vec4 &p2) {
+    QVector<Point3> cells;
+    rasterizeLine(p1, p2, cells);
+    QSet<OctNode *> modifiedNodes;
+    for (Point3 &p : cells) {
+        addVoxel(modifiedNodes, p);
+    }
     for (OctNode *node : modifiedNodes) {
-        node->chunk->create();
+        node->chunk->update();
     }
 }
 
 void Scene::voxelize(const QVector<LPair_t> &pairs, const Point3 &pt) {
+    TraceScope trace("voxelize", "edit", (int) glm::floor(pt.x/16), (int) glm::floor(pt.y/16), (int) glm::floor(pt.z/16));
+    // The turtle walks the structure here; the branches it draws are rasterized as jobs, then
+    // written into the chunks in order on this thread, since the octree can't be shared
+    QVector<glm::vec4> starts, ends;
     glm::mat4 worldTransform = glm::translate(glm::mat4(), glm::vec3(pt.x, pt.y, pt.z));
     for (LPair_t pair : pairs) {
         glm::mat4 newTransform = worldTransform * pair.t;
         if (pair.draw) {
-            bresenham(worldTransform[3], newTransform[3]);
+            starts.append(worldTransform[3]);
+            ends.append(newTransform[3]);
         }
         worldTransform = newTransform;
     }
+    QVector<QVector<Point3>> lines(starts.size());
+    QVector<Point3> *line_data = lines.data();
+    JobSystem::parallelFor(lines.size(), LINES_PER_JOB, [&](int first, int end) {
+        for (int i = first; i < end; i++) {
+            rasterizeLine(starts.at(i), ends.at(i), line_data[i]);
+        }
+    });
+    QSet<OctNode *> modifiedNodes;
+    for (QVector<Point3> &line : lines) {
+        for (Point3 &p : line) {
+            addVoxel(modifiedNodes, p);
+        }
+    }
+    for (OctNode *node : modifiedNodes) {
+        node->chunk->update();
+    }
 }
 
 /**
@@ -137,10 +174,12 @@ void Scene::parseImage(QImage image, glm::vec3 eye) {
             }
         }
     }
+    // One QMap node per pixel: key, value, three links and a colour
+    heightmap_memory.set(heightmap.size() * (sizeof(Point) + sizeof(float) + 4 * sizeof(void*)), heightmap.size());
     CreateNewChunks();
 }
 
-Chunk* Scene::getContainingChunk(Point3 p) const {
+ChunkData* Scene::getContainingChunk(Point3 p) const {
     return getContainingNode(p)->chunk;
 }
 
@@ -164,7 +203,7 @@ Point3 Scene::worldToChunk(Point3 p)
 
 bool Scene::isFilled(Point3 p)
 {
-    Chunk* chunk = getContainingChunk(p);
+    ChunkData* chunk = getContainingChunk(p);
     if (!chunk) {   // Chunk doesn't exist
         return false;
     }
@@ -186,76 +225,151 @@ bool Scene::isFilled(Point3 p)
     return false;
 }
 
-// Called whenever the camera moves to a different chunk
-void Scene::CreateNewChunks()
+// Floor division by the chunk size that also works for negative coordinates
+static inline int chunkCoord(int v)
 {
-    for (int x_chunk = 0; x_chunk < num_chunks; x_chunk++) {
-        for (int z_chunk = 0; z_chunk < num_chunks; z_chunk++) {
-            Point3 p = Point3(x_chunk*16.0f + origin.x, 0, z_chunk*16.0f + origin.z);
-            // Must generate a new chunk VBO because octree is empty at that point
-            if (!getContainingNode(p)->chunk) {
-                for (int y_chunk = 0; y_chunk < MAX_TERRAIN_HEIGHT; y_chunk++) {
-                    Point3 p_y = Point3(p.x, y_chunk*16.0f, p.z);
-                    Chunk* chunk = new Chunk(p_y.y);
-                    for (int x = 0; x < 16; x++) {
-                        for (int z = 0; z < 16; z++) {
-                            int x_coord = x + x_chunk*16.0f;
-                            int z_coord = z + z_chunk*16.0f;
-                            float height = terrain.getBlock(x_coord / (float) dimensions[0],
-                                                            z_coord / (float) dimensions[2]);
-                            if (heightmap.contains(Point(x_coord + origin.x, z_coord + origin.z))) {
-                                height = heightmap[Point(x_coord + origin.x, z_coord + origin.z)];
-                            }
-                            if (height < 1) {
-                                height = 1.0f;
-                            }
-                            for (int y = y_chunk*16; y < height; y++) {
-                                if (y >= (y_chunk+1)*16) {
-                                    break;
-                                }
+    return v >= 0 ? v / 16 : (v - 15) / 16;
+}
 
-                                //STONE
-                                if (y < 7) {
-                                    chunk->cells[x][y-y_chunk*16][z] = STONE;
-                                }
+// Direct block lookup for hot paths like collision. Unlike isFilled it never builds
+// out the octree or copies cell lists; blocks in unloaded chunks read as EMPTY.
+Texture Scene::getBlock(int x, int y, int z) const
+{
+    int cx = chunkCoord(x), cy = chunkCoord(y), cz = chunkCoord(z);
+    const Point3 &base = octree->base;
+    if (cx < base.x || cy < base.y || cz < base.z ||
+            cx >= base.x + octree->length || cy >= base.y + octree->length || cz >= base.z + octree->length) {
+        return EMPTY;
+    }
+    OctNode* node = octree->getContainingNode(Point3(cx, cy, cz));
+    if (!node || node->length != 1 || !node->chunk) {
+        return EMPTY;
+    }
+    return node->chunk->cells.at(x - cx*16).at(y - cy*16).at(z - cz*16);
+}
 
-                                //LAVA
-                                else if (y >= 7 && y < 9) {
-                                    chunk->cells[x][y-y_chunk*16][z] = LAVA;
-                                }
+// The block generated terrain has at height y, from the layers in TERRAIN_LAYERS
+Texture Scene::terrainBlock(int y)
+{
+    for (const TerrainLayer &layer : TERRAIN_LAYERS) {
+        if (y < layer.top) {
+            return layer.block;
+        }
+    }
+    return TERRAIN_SURFACE;
+}
 
-                                //WATER
-                                else if (y >= 9 && y < 12) {
-                                    chunk->cells[x][y-y_chunk*16][z] = WATER;
-                                }
+// Height of the generated terrain at any world x/z, including beyond the loaded chunks.
+// CreateNewChunks generates its columns from it too.
+float Scene::terrainHeight(float x, float z)
+{
+    Point p(x, z);
+    float height;
+    if (heightmap.contains(p)) {
+        height = heightmap[p];
+    } else {
+        height = terrain.sample((x - origin.x) / (float) dimensions[0],
+                                (z - origin.z) / (float) dimensions[2]);
+    }
+    return height < 1 ? 1.0f : height;
+}
+
+glm::ivec2 Scene::windowMin() const
+{
+    return glm::ivec2(origin.x, origin.z) - glm::ivec2(WINDOW_MARGIN * 16);
+}
+
+glm::ivec2 Scene::windowMax() const
+{
+    return glm::ivec2(origin.x, origin.z) + glm::ivec2((num_chunks + WINDOW_MARGIN) * 16);
+}
 
-                                //WOOD
-                                else if (y == 12) {
-                                    chunk->cells[x][y-y_chunk*16][z] = WOOD;
-                                }
+static void remeshNode(OctNode *node)
+{
+    if (node->chunk) {
+        node->chunk->update();
+    }
+    for (OctNode *child : node->children) {
+        remeshNode(child);
+    }
+}
 
-                                //GRASS
-                                else if (y >= 13 && y < 20) {
-                                    chunk->cells[x][y-y_chunk*16][z] = GRASS;
-                                }
+void Scene::remeshChunks()
+{
+    remeshNode(octree);
+}
 
-                                //WATER
-                                else if (y == 20) {
-                                    chunk->cells[x][y-y_chunk*16][z] = WATER;
-                                }
+/**
+ * @brief Scene::fillChunk - creates the chunk y_chunk chunks up a column of terrain
+ * Cells are filled up to the height of their column of blocks, with the block terrainBlock
+ * gives each layer; heights below 1 are raised to 1. Only reads its arguments, so columns can
+ * be filled on worker threads.
+ * @param heights - the height of each of the 16x16 columns of blocks, at x * 16 + z
+ */
+ChunkData* Scene::fillChunk(const float *heights, int y_chunk)
+{
+    ChunkData* chunk = new ChunkData(y_chunk*16);
+    for (int x = 0; x < 16; x++) {
+        for (int z = 0; z < 16; z++) {
+            float height = heights[x*16 + z];
+            if (height < 1) {
+                height = 1.0f;
+            }
+            for (int y = y_chunk*16; y < height; y++) {
+                if (y >= (y_chunk+1)*16) {
+                    break;
+                }
+                chunk->cells[x][y-y_chunk*16][z] = terrainBlock(y);
+            }
+        }
+    }
+    chunk->update();
+    return chunk;
+}
 
-                                //GRASS; y > 20
-                                else {
-                                    chunk->cells[x][y-y_chunk*16][z] = GRASS;
-                                }
-                            }
-                        }
+// Called whenever the camera moves to a different chunk
+// Heights are read on this thread, since Terrain caches them as it goes. The chunks are filled by
+// jobs, one per chunk, which hand them back through a queue to be placed in the octree here
+void Scene::CreateNewChunks()
+{
+    ProfileScope scope(PHASE_GENERATE);
+    QVector<Point3> columns;
+    QVector<float> column_heights;
+    glm::ivec2 window_min = windowMin();
+    glm::ivec2 window_max = windowMax();
+    for (int x_block = window_min.x; x_block < window_max.x; x_block += 16) {
+        for (int z_block = window_min.y; z_block < window_max.y; z_block += 16) {
+            Point3 p = Point3(x_block, 0, z_block);
+            // Must generate a new chunk VBO because octree is empty at that point
+            if (!getContainingNode(p)->chunk) {
+                columns.append(p);
+                column_heights.resize(columns.size() * 16*16);
+                float *heights = column_heights.data() + (columns.size() - 1) * 16*16;
+                for (int x = 0; x < 16; x++) {
+                    for (int z = 0; z < 16; z++) {
+                        heights[x*16 + z] = terrainHeight(x_block + x, z_block + z);
                     }
-                    chunk->create();
-                    OctNode* leaf = getContainingNode(p_y);
-                    leaf->setChunk(chunk);
                 }
             }
         }
     }
+
+    const float *height_data = column_heights.constData();
+    JobSystem::parallelFor(columns.size() * MAX_TERRAIN_HEIGHT, 1, [&](int first, int end) {
+        for (int i = first; i < end; i++) {
+            const Point3 &p = columns.at(i / MAX_TERRAIN_HEIGHT);
+            int y_chunk = i % MAX_TERRAIN_HEIGHT;
+            glm::ivec3 cell((int) glm::floor(p.x/16), y_chunk, (int) glm::floor(p.z/16));
+            TraceScope trace("generate", "chunk", cell.x, cell.y, cell.z);
+            // Leaves the chunk DIRTY, ready to be meshed once it is placed
+            ChunkData *chunk = fillChunk(height_data + i / MAX_TERRAIN_HEIGHT * 16*16, y_chunk);
+            chunk->cell = cell;
+            generated.push(chunk);
+        }
+    });
+    // The octree isn't safe to change from several threads
+    ChunkData *chunk;
+    while (generated.pop(chunk)) {
+        getContainingNode(Point3(chunk->cell.x * 16.0f, chunk->cell.y * 16.0f, chunk->cell.z * 16.0f))->setChunk(chunk);
+    }
 }
@@ -1,11 +1,13 @@
 #pragma once
 #include <QList>
-#include <scene/camera.h>
+#include <QImage>
 #include "terrain/terrain.h"
 #include "point3.h"
-#include <scene/geometry/chunk.h>
+#include <scene/chunkdata.h>
+#include <scene/octnode.h>
 #include "generators/lparser.h"
-#include <QOpenGLTexture>
+#include <memorystats.h>
+#include <mpscqueue.h>
 
 
 class Scene {
@@ -13,20 +15,34 @@ class Scene {
     static const int WORLD_DIM = 64;
 
 public:
+    // Number of chunk layers generated upward from y = 0
+    static const int MAX_TERRAIN_HEIGHT = 6;    // Fix dis; make # of y_chunks generated dependent on Perlin noise height
+    // Chunks generated on every side of the num_chunks x num_chunks square at the origin
+    static const int WINDOW_MARGIN = 4;
+
     Scene();
-    QOpenGLTexture* texture;
     //void CreateChunkScene();
     void CreateNewChunks();
     void CreateNewChunks(Point UL, Point LR);
     void shift(int dx, int dy, int dz);
 
-    Chunk* getContainingChunk(Point3 p) const;
+    ChunkData* getContainingChunk(Point3 p) const;
     OctNode* getContainingNode(Point3 p) const;
     Point3 worldToChunk(Point3 p);
     void voxelize(const QVector<LPair_t> &pairs, const Point3 &pt);
     void bresenham(const glm::vec4 &p1, const glm::vec4 &p2);
+    static void rasterizeLine(const glm::vec4 &p1, const glm::vec4 &p2, QVector<Point3> &cells);
     bool isFilled(Point3 p);
+    Texture getBlock(int x, int y, int z) const;
+    static Texture terrainBlock(int y);
+    static ChunkData* fillChunk(const float *heights, int y_chunk);
+    float terrainHeight(float x, float z);
+    // Smallest and largest x/z of the window of chunks CreateNewChunks generates, in blocks
+    glm::ivec2 windowMin() const;
+    glm::ivec2 windowMax() const;
     void parseImage(QImage image, glm::vec3 eye);
+    // Marks every loaded chunk changed so it is meshed again, e.g. after the mesh format changes
+    void remeshChunks();
 
     glm::ivec3 dimensions;
     glm::vec3 origin;
@@ -38,4 +54,7 @@ public:
 private:
     void addVoxel(QSet<OctNode *> &set, Point3 &p);
     QMap<Point, float> heightmap;
+    MemoryGauge heightmap_memory;
+    // Chunks generation jobs have filled, waiting to be placed in the octree
+    MpscQueue<ChunkData*> generated;
 };
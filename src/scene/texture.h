@@ -5,4 +5,7 @@ enum Texture {
     GRASS = 0, WOOD, STONE, LAVA, WATER, EMPTY
 };
 
+// Number of Texture values, EMPTY included; see BLOCKS in blocks.h
+static const int BLOCK_TYPES = EMPTY + 1;
+
 #endif // TEXTURE_H
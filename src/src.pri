@@ -2,61 +2,60 @@ INCLUDEPATH += $$PWD
 DEPENDPATH += $$PWD
 #LIBS += -L$$PWD/lib -ltbb
 
+# The window and everything that draws. The GL-free rest of the engine is linked from the
+# world library, see world/world.pro
+LIBS += -L$$OUT_PWD/../world -lworld
+PRE_TARGETDEPS += $$OUT_PWD/../world/libworld.a
+
 SOURCES += \
     $$PWD/main.cpp \
     $$PWD/mainwindow.cpp \
     $$PWD/mygl.cpp \
     $$PWD/scene/camera.cpp \
-    $$PWD/scene/scene.cpp \
     $$PWD/scene/geometry/cube.cpp \
     $$PWD/openGL/drawable.cpp \
     $$PWD/openGL/glwidget277.cpp \
     $$PWD/openGL/shaderprogram.cpp \
-    $$PWD/scene/transform.cpp \
+    $$PWD/openGL/chunkarena.cpp \
+    $$PWD/openGL/chunkmesh.cpp \
+    $$PWD/openGL/tilearray.cpp \
     $$PWD/cameracontrolshelp.cpp \
-    $$PWD/terrain/terrain.cpp \
-    $$PWD/terrain/point.cpp \
-    $$PWD/scene/point3.cpp \
     $$PWD/util.cpp \
-    $$PWD/scene/geometry/chunk.cpp \
     $$PWD/scene/geometry/segment.cpp \
     $$PWD/scene/geometry/cylinder.cpp \
-    $$PWD/generators/lparser.cpp \
-    $$PWD/scene/octnode.cpp \
-    $$PWD/scene/geometry/cross.cpp \
-    $$PWD/scene/ray.cpp \
-    $$PWD/ui/keypassgraphicsview.cpp \
-    $$PWD/scene/intersection.cpp \
-    $$PWD/soundmanager.cpp
+    $$PWD/scene/geometry/overlay.cpp \
+    $$PWD/scene/inventory.cpp \
+    $$PWD/scene/geometry/farfield.cpp \
+    $$PWD/scene/frustum.cpp \
+    $$PWD/scene/occlusion.cpp \
+    $$PWD/scene/cavecull.cpp \
+    $$PWD/soundmanager.cpp \
+    $$PWD/benchmark.cpp
 
 HEADERS += \
     $$PWD/mainwindow.h \
     $$PWD/mygl.h \
     $$PWD/scene/camera.h \
-    $$PWD/la.h \
     $$PWD/drawable.h \
-    $$PWD/scene/scene.h \
     $$PWD/scene/geometry/cube.h \
     $$PWD/openGL/drawable.h \
     $$PWD/openGL/glwidget277.h \
     $$PWD/openGL/shaderprogram.h \
-    $$PWD/scene/transform.h \
+    $$PWD/openGL/chunkarena.h \
+    $$PWD/openGL/chunkmesh.h \
+    $$PWD/openGL/tilearray.h \
     $$PWD/scene/materials/material.h \
     $$PWD/raytracing/film.h \
     $$PWD/raytracing/integrator.h \
     $$PWD/cameracontrolshelp.h \
-    $$PWD/terrain/terrain.h \
-    $$PWD/terrain/point.h \
-    $$PWD/scene/point3.h \
     $$PWD/util.h \
-    $$PWD/scene/geometry/chunk.h \
     $$PWD/scene/geometry/segment.h \
     $$PWD/scene/geometry/cylinder.h \
-    $$PWD/generators/lparser.h \
-    $$PWD/scene/octnode.h \
-    $$PWD/scene/geometry/cross.h \
-    $$PWD/scene/texture.h \
-    $$PWD/scene/ray.h \
-    $$PWD/ui/keypassgraphicsview.h \
-    $$PWD/scene/intersection.h \
-    $$PWD/soundmanager.h
+    $$PWD/scene/geometry/overlay.h \
+    $$PWD/scene/inventory.h \
+    $$PWD/scene/geometry/farfield.h \
+    $$PWD/scene/frustum.h \
+    $$PWD/scene/occlusion.h \
+    $$PWD/scene/cavecull.h \
+    $$PWD/soundmanager.h \
+    $$PWD/benchmark.h
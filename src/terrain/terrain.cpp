@@ -1,6 +1,5 @@
 #include "terrain.h"
 #include <stdio.h>      /* printf, scanf, puts, NULL */
-#include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 #include <math.h>
 #include <iostream>
@@ -35,9 +34,11 @@ void shiftBounds(Bounds_t &bounds, int dx, int dy) {
     bounds.ymin += dy;
 }
 
-Terrain::Terrain(int maxX, int maxY, int fequencyDivisor) {
+unsigned int Terrain::seed = 0;
+
+Terrain::Terrain(int maxX, int maxY, int fequencyDivisor) : memory(MEM_TERRAIN) {
     this->frequencyDivisor = fequencyDivisor;
-    srand(time(NULL));
+    this->gradient_seed = seed != 0 ? seed : time(NULL);
     for (int i = 0; i < maxX / fequencyDivisor; i++) {
         for (int j = 0; j < maxY / fequencyDivisor; j++) {
             createSeed(i, j);
@@ -46,22 +47,52 @@ Terrain::Terrain(int maxX, int maxY, int fequencyDivisor) {
     this->bounds = makeBounds(0, 0, maxY / frequencyDivisor, maxY / frequencyDivisor);
 }
 
+/**
+ * @brief hashGradient - one component of the gradient at a lattice point
+ * Mixes the seed, the point and the component with the MurmurHash3 finalizer, so every point
+ * gets the same gradient however the seeds around it were created.
+ * @return a value in [0, 1)
+ */
+static float hashGradient(unsigned int seed, int i, int j, int component) {
+    quint32 h = seed;
+    h = h * 0x9e3779b1u + (quint32) i;
+    h = h * 0x9e3779b1u + (quint32) j;
+    h = h * 0x9e3779b1u + (quint32) component;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return (h >> 8) / 16777216.0f;
+}
+
 void Terrain::createSeed(int i, int j, bool checkExists) {
     Point p(i, j);
     if (checkExists && gradients.contains(p)) {
         return;
     }
     QVector<float> v;
-    float random = ((float) rand()) / (float) RAND_MAX;
-    v.push_back(random);
-    random = ((float) rand()) / (float) RAND_MAX;
-    v.push_back(random);
+    v.push_back(hashGradient(gradient_seed, i, j, 0));
+    v.push_back(hashGradient(gradient_seed, i, j, 1));
     gradients.insert(p, v);
+    updateMemory();
 }
 
 void Terrain::removeSeed(int i, int j) {
     Point p(i, j);
     gradients.remove(p);
+    updateMemory();
+}
+
+// Estimates of one QMap entry: the node's key and value plus its three links and colour, and
+// for gradients the vector's two floats behind a shared array header
+static const qint64 MAP_NODE_BYTES = 4 * sizeof(void*);
+static const qint64 GRADIENT_BYTES = MAP_NODE_BYTES + sizeof(Point) + sizeof(QVector<float>) + 24 + 2 * sizeof(float);
+static const qint64 HEIGHT_BYTES = MAP_NODE_BYTES + sizeof(Point) + sizeof(float);
+
+void Terrain::updateMemory() {
+    memory.set(gradients.size() * GRADIENT_BYTES + heightmap.size() * HEIGHT_BYTES,
+               gradients.size() + heightmap.size());
 }
 
 float Terrain::getBlock(float x, float y) {
@@ -72,12 +103,32 @@ float Terrain::getBlock(float x, float y) {
     if (!heightmap.contains(p)) {
         height = getHeight(x, y);
         heightmap[p] = height;
+        updateMemory();
     } else {
         height = heightmap[p];
     }
     return getHeight(x, y);
 }
 
+/**
+ * @brief removeOutside - utility function to drop the entries of a map keyed by seed position
+ * that lie outside a bounding box
+ * @param map - the map to clean up
+ * @param keep - the box of entries to keep
+ */
+template <class T>
+static void removeOutside(QMap<Point, T> &map, const Bounds_t &keep) {
+    typename QMap<Point, T>::iterator it = map.begin();
+    while (it != map.end()) {
+        const Point &p = it.key();
+        if (p.x < keep.xmin || p.x > keep.xmax || p.y < keep.ymin || p.y > keep.ymax) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 /*
  * Use this function to create new terrain and destroy old terrain that is outside of the max range.
  * For example, we can shift +x/+y and dealloc the old blocks that were part of the original terrain
@@ -105,12 +156,18 @@ void Terrain::shift(int idx, int idy) {
         }
     }
 
-    // clean up the heightmap cache
-    //    for (Point p : heightmap.keys()) {
-    //        if (p.x > bounds.xmax || p.x < bounds.xmin || p.y > bounds.ymax || p.y < bounds.ymin) {
-    //            heightmap.remove(p);
-    //        }
-    //    }
+    // clean up the seeds and the heightmap cache beyond what can still be sampled
+    if (keep_margin >= 0) {
+        Bounds_t keep = makeBounds(bounds.xmin - keep_margin, bounds.ymin - keep_margin,
+                                   bounds.xmax + keep_margin, bounds.ymax + keep_margin);
+        removeOutside(gradients, keep);
+        removeOutside(heightmap, keep);
+        updateMemory();
+    }
+}
+
+void Terrain::setKeepDistance(int blocks) {
+    keep_margin = blocks < 0 ? -1 : blocks / frequencyDivisor + 1;
 }
 
 /**
@@ -132,12 +189,15 @@ float lerp(float a0, float a1, float w) {
  * @param dy
  * @return the value of the dot at the location x, y
  */
-float Terrain::dotGridGradient(int x, int y, float dx, float dy) {
+float Terrain::dotGridGradient(int x, int y, float dx, float dy) const {
     float rx = fabs(dx - x);
     float ry = fabs( dy - y);
-    Point p = Point(x, y);
-
-    return rx * gradients[p][0] + ry * gradients[p][1];
+    // Seeds that were never created count as flat
+    QMap<Point, QVector<float>>::const_iterator gradient = gradients.constFind(Point(x, y));
+    if (gradient == gradients.constEnd()) {
+        return 0;
+    }
+    return rx * gradient.value()[0] + ry * gradient.value()[1];
 }
 
 float clamp(float n, float lower, float upper) {
@@ -161,13 +221,60 @@ float Terrain::getHeight(float x, float y) {
     float sx = unfloored_x - (float) x0;
     float sy = unfloored_y - (float) y0;
 
+    // Measured from the lattice origin rather than from the bounds, so a shift doesn't change
+    // the height at a point
+    float px = unfloored_x / (bounds.xmax - bounds.xmin);
+    float py = unfloored_y / (bounds.ymax - bounds.ymin);
+
     float n0, n1, ix0, ix1, value;
-    n0 = dotGridGradient(x0, y0, x, y);
-    n1 = dotGridGradient(x1, y0, x, y);
+    n0 = dotGridGradient(x0, y0, px, py);
+    n1 = dotGridGradient(x1, y0, px, py);
     ix0 = lerp(n0, n1, sx);
-    n0 = dotGridGradient(x0, y1, x, y);
-    n1 = dotGridGradient(x1, y1, x, y);
+    n0 = dotGridGradient(x0, y1, px, py);
+    n1 = dotGridGradient(x1, y1, px, py);
     ix1 = lerp(n0, n1, sx);
     value = lerp(ix0, ix1, sy);
     return value;
 }
+
+float Terrain::sample(float x, float y) {
+    createSeeds(x, y, x, y);
+    return sampleSeeded(x, y);
+}
+
+void Terrain::createSeeds(float x0, float y0, float x1, float y1) {
+    int i0 = floor((x0 * (bounds.xmax - bounds.xmin)) + (bounds.xmin));
+    int j0 = floor((y0 * (bounds.ymax - bounds.ymin)) + (bounds.ymin));
+    int i1 = floor((x1 * (bounds.xmax - bounds.xmin)) + (bounds.xmin)) + 1;
+    int j1 = floor((y1 * (bounds.ymax - bounds.ymin)) + (bounds.ymin)) + 1;
+    for (int j = j0; j <= j1; j++) {
+        for (int i = i0; i <= i1; i++) {
+            createSeed(i, j, true);
+        }
+    }
+}
+
+float Terrain::sampleSeeded(float x, float y) const {
+    float unfloored_x = (x * (bounds.xmax - bounds.xmin)) + (bounds.xmin);
+    float unfloored_y = (y * (bounds.ymax - bounds.ymin)) + (bounds.ymin);
+
+    int x0 = floor(unfloored_x);
+    int y0 = floor(unfloored_y);
+    int x1 = x0 + 1;
+    int y1 = y0 + 1;
+
+    float sx = unfloored_x - (float) x0;
+    float sy = unfloored_y - (float) y0;
+
+    float px = unfloored_x / (bounds.xmax - bounds.xmin);
+    float py = unfloored_y / (bounds.ymax - bounds.ymin);
+
+    float n0, n1, ix0, ix1;
+    n0 = dotGridGradient(x0, y0, px, py);
+    n1 = dotGridGradient(x1, y0, px, py);
+    ix0 = lerp(n0, n1, sx);
+    n0 = dotGridGradient(x0, y1, px, py);
+    n1 = dotGridGradient(x1, y1, px, py);
+    ix1 = lerp(n0, n1, sx);
+    return lerp(ix0, ix1, sy);
+}
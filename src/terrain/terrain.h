@@ -4,11 +4,8 @@
 #include "la.h"
 #include "point.h"
 #include <QMap>
-#include <scene/geometry/chunk.h>
-#include <scene/point3.h>
-#include <scene/octnode.h>
-#include <QImage>
-#include <QOpenGLTexture>
+#include <QVector>
+#include <memorystats.h>
 
 struct Bounds_t {
     int xmin;
@@ -19,20 +16,40 @@ struct Bounds_t {
 
 class Terrain {
 public:
+    // Seeds the gradients of every Terrain created afterwards; 0 seeds from the clock. Each
+    // gradient is a hash of the seed and its lattice point, so it doesn't matter in what order
+    // or how many times seeds are created
+    static unsigned int seed;
+
     Terrain(int maxX, int maxY, int frequenceDivisor = 8);
     void shift(int dx, int dy);
     float getBlock(float x, float y);
+    // Like getBlock, but not limited to the current bounds; missing seeds are created
+    float sample(float x, float y);
+    // Creates every seed sample needs inside the rectangle from (x0, y0) to (x1, y1)
+    void createSeeds(float x0, float y0, float x1, float y1);
+    // Like sample, but never creates seeds, so several threads may call it at once. Points
+    // must be covered by createSeeds first
+    float sampleSeeded(float x, float y) const;
     void setHeight(float x, float y, float height);
+    // Seeds and cached heights more than this many blocks outside the bounds are dropped by
+    // shift, so moving around doesn't grow them without end; they come back the same when
+    // sampled again. -1 keeps them all
+    void setKeepDistance(int blocks);
 private:
     Bounds_t bounds;
+    unsigned int gradient_seed;
     QMap<Point, QVector<float>> gradients;
     int frequencyDivisor;
+    int keep_margin = -1;   // in seeds, see setKeepDistance
     void createSeed(int i, int j, bool checkExists = false);
     void removeSeed(int i, int j);
     float getHeight(float x, float y);
 
-    float dotGridGradient(int x, int y, float dx, float dy);
+    float dotGridGradient(int x, int y, float dx, float dy) const;
     QMap<Point, float> heightmap;
+    MemoryGauge memory;
+    void updateMemory();
 };
 
 #endif // TERRAIN_H
@@ -0,0 +1,147 @@
+#include "trace.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <chrono>
+
+const int Trace::CAPACITY;
+const int Trace::NO_CHUNK;
+
+namespace {
+
+// Written only by the thread that owns it. head counts every event ever recorded; the event
+// with index i lives in events[i % CAPACITY]
+struct TraceBuffer {
+    TraceEvent events[Trace::CAPACITY];
+    std::atomic<quint64> head;
+    int tid;
+    QString thread_name;
+};
+
+// Buffers are registered once per thread and kept until exit, so events from worker
+// threads that have finished can still be written
+QMutex registry_lock;
+QVector<TraceBuffer*> registry;
+
+thread_local TraceBuffer *local_buffer = nullptr;
+
+TraceBuffer* threadBuffer()
+{
+    if (!local_buffer) {
+        TraceBuffer *buffer = new TraceBuffer();
+        buffer->head.store(0);
+        QCoreApplication *app = QCoreApplication::instance();
+        bool main = app && QThread::currentThread() == app->thread();
+        QMutexLocker locker(&registry_lock);
+        buffer->tid = registry.size();
+        buffer->thread_name = main ? QString("main") : QString("worker %1").arg(buffer->tid);
+        registry.append(buffer);
+        local_buffer = buffer;
+    }
+    return local_buffer;
+}
+
+// Copies the events of buffer that are still intact. The owner may be overwriting the slot
+// after the last published event while this runs, so anything that slot could have held is
+// dropped once the copy is done
+QVector<TraceEvent> snapshot(TraceBuffer *buffer)
+{
+    quint64 end = buffer->head.load(std::memory_order_acquire);
+    quint64 begin = end > (quint64) Trace::CAPACITY ? end - Trace::CAPACITY : 0;
+    QVector<TraceEvent> events;
+    events.reserve(end - begin);
+    for (quint64 i = begin; i < end; i++) {
+        events.append(buffer->events[i % Trace::CAPACITY]);
+    }
+    quint64 head = buffer->head.load(std::memory_order_acquire);
+    quint64 first_intact = head + 1 > (quint64) Trace::CAPACITY ? head + 1 - Trace::CAPACITY : 0;
+    if (first_intact > begin) {
+        events.remove(0, (int) std::min<quint64>(first_intact - begin, events.size()));
+    }
+    return events;
+}
+
+}
+
+qint64 Trace::now()
+{
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char *name, const char *category, qint64 start, qint64 duration, int x, int y, int z)
+{
+    TraceBuffer *buffer = threadBuffer();
+    quint64 index = buffer->head.load(std::memory_order_relaxed);
+    TraceEvent &event = buffer->events[index % CAPACITY];
+    event.name = name;
+    event.category = category;
+    event.start = start;
+    event.duration = duration;
+    event.x = x;
+    event.y = y;
+    event.z = z;
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+void Trace::instant(const char *name, const char *category, int x, int y, int z)
+{
+    record(name, category, now(), -1, x, y, z);
+}
+
+/**
+ * @brief Trace::write - writes the buffered events of every thread as trace event JSON
+ * Complete events ("ph": "X") and instant events ("ph": "i") carry their chunk coordinates as
+ * args; each thread also gets a thread_name metadata event so the timeline rows are labelled.
+ * Timestamps are in microseconds, as the format expects.
+ */
+bool Trace::write(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    QVector<TraceBuffer*> buffers;
+    {
+        QMutexLocker locker(&registry_lock);
+        buffers = registry;
+    }
+
+    QTextStream out(&file);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for (TraceBuffer *buffer : buffers) {
+        out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << buffer->tid << ", \"args\": {\"name\": \"" << buffer->thread_name << "\"}}";
+        first = false;
+        for (const TraceEvent &e : snapshot(buffer)) {
+            out << ",\n{\"name\": \"" << e.name << "\", \"cat\": \"" << e.category
+                << "\", \"pid\": 1, \"tid\": " << buffer->tid << ", \"ts\": " << e.start / 1e3;
+            if (e.duration >= 0) {
+                out << ", \"ph\": \"X\", \"dur\": " << e.duration / 1e3;
+            } else {
+                out << ", \"ph\": \"i\", \"s\": \"t\"";
+            }
+            if (e.x != NO_CHUNK) {
+                out << ", \"args\": {\"x\": " << e.x << ", \"y\": " << e.y << ", \"z\": " << e.z << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return true;
+}
+
+TraceScope::TraceScope(const char *name, const char *category, int x, int y, int z)
+    : name(name), category(category), start(Trace::now()), x(x), y(y), z(z)
+{}
+
+TraceScope::~TraceScope()
+{
+    Trace::record(name, category, start, Trace::now() - start, x, y, z);
+}
@@ -0,0 +1,52 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <climits>
+
+// One recorded event. Names and categories must be string literals: only the pointer is kept
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    qint64 start;       // nanoseconds on the trace clock
+    qint64 duration;    // nanoseconds, or -1 for an instant event
+    int x, y, z;        // chunk coordinates, or Trace::NO_CHUNK
+};
+
+// Records timeline events into a ring buffer per thread and writes them out in the Chrome
+// trace event format, which chrome://tracing and ui.perfetto.dev open. Recording takes no lock:
+// each thread only ever writes its own buffer, and publishes an event by bumping the buffer's
+// atomic head after filling it in. When a buffer is full the oldest events are overwritten.
+class Trace
+{
+public:
+    static const int CAPACITY = 8192;   // events kept per thread
+    static const int NO_CHUNK = INT_MIN;
+
+    static qint64 now();
+    static void record(const char *name, const char *category, qint64 start, qint64 duration,
+                       int x = NO_CHUNK, int y = NO_CHUNK, int z = NO_CHUNK);
+    static void instant(const char *name, const char *category,
+                        int x = NO_CHUNK, int y = NO_CHUNK, int z = NO_CHUNK);
+    // Writes every thread's buffered events as trace event JSON; false if the file can't be written
+    static bool write(const QString &path);
+};
+
+// Records a complete event spanning its own lifetime
+class TraceScope
+{
+public:
+    TraceScope(const char *name, const char *category,
+               int x = Trace::NO_CHUNK, int y = Trace::NO_CHUNK, int z = Trace::NO_CHUNK);
+    ~TraceScope();
+
+private:
+    const char *name;
+    const char *category;
+    qint64 start;
+    int x, y, z;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,46 @@
+# The world: chunks, terrain, the octree and L-systems. Nothing here uses OpenGL, so it
+# builds as a library that runs without a context; see world/world.pro
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/scene/scene.cpp \
+    $$PWD/scene/octnode.cpp \
+    $$PWD/scene/chunkdata.cpp \
+    $$PWD/scene/meshdata.cpp \
+    $$PWD/scene/transform.cpp \
+    $$PWD/scene/point3.cpp \
+    $$PWD/scene/ray.cpp \
+    $$PWD/scene/intersection.cpp \
+    $$PWD/scene/raybatch.cpp \
+    $$PWD/scene/physics.cpp \
+    $$PWD/terrain/terrain.cpp \
+    $$PWD/terrain/point.cpp \
+    $$PWD/generators/lparser.cpp \
+    $$PWD/profiler.cpp \
+    $$PWD/jobs.cpp \
+    $$PWD/trace.cpp \
+    $$PWD/memorystats.cpp
+
+HEADERS += \
+    $$PWD/la.h \
+    $$PWD/scene/scene.h \
+    $$PWD/scene/octnode.h \
+    $$PWD/scene/chunkdata.h \
+    $$PWD/scene/meshdata.h \
+    $$PWD/scene/texture.h \
+    $$PWD/scene/blocks.h \
+    $$PWD/scene/transform.h \
+    $$PWD/scene/point3.h \
+    $$PWD/scene/ray.h \
+    $$PWD/scene/intersection.h \
+    $$PWD/scene/raybatch.h \
+    $$PWD/scene/physics.h \
+    $$PWD/terrain/terrain.h \
+    $$PWD/terrain/point.h \
+    $$PWD/generators/lparser.h \
+    $$PWD/profiler.h \
+    $$PWD/trace.h \
+    $$PWD/memorystats.h \
+    $$PWD/jobs.h \
+    $$PWD/mpscqueue.h
@@ -0,0 +1,14 @@
+# QtGui is only needed for QImage and QMatrix4x4; nothing here uses OpenGL
+QT += core gui
+
+TARGET = world
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG += c++11
+CONFIG += warn_on
+# Optimized, so the microbenchmarks time the code the game runs, but still debuggable
+CONFIG += release force_debug_info
+
+INCLUDEPATH += $$PWD/../include
+
+include(../src/world.pri)
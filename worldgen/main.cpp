@@ -0,0 +1,311 @@
+#include <scene/scene.h>
+#include <scene/chunkdata.h>
+#include <scene/meshdata.h>
+#include <terrain/terrain.h>
+#include <memorystats.h>
+#include <jobs.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <stdio.h>
+#include <sys/resource.h>
+
+// Generates a rectangle of chunk columns without a window or a GL context, the same way the
+// game does, and reports how fast it went. Columns are generated in parallel on the job
+// system; --threads sets how many threads run jobs, to measure how generation scales.
+
+static const int SCENE_DIM = 80;            // blocks the terrain's [0, 1] range spans, as in Scene
+static const quint32 FILE_MAGIC = 0x32373777;   // "277w"
+static const quint32 FILE_VERSION = 1;
+
+// One column of chunks, bottom to top, with their meshes when meshing was asked for
+struct Column {
+    int x, z;                   // in chunks
+    QVector<ChunkData*> chunks;
+    QVector<MeshData> meshes;
+};
+
+struct Stage {
+    QString name;
+    double ms;
+};
+
+// Largest resident set of the process so far. Linux reports it in kilobytes, macOS in bytes
+static qint64 peakRss()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss;
+#else
+    return (qint64) usage.ru_maxrss * 1024;
+#endif
+}
+
+// Parses "x0,z0,x1,z1" into the columns from (x0, z0) up to but not including (x1, z1)
+static bool parseRect(const QString &text, int rect[4])
+{
+    QStringList parts = text.split(",");
+    if (parts.size() != 4) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        bool ok;
+        rect[i] = parts[i].trimmed().toInt(&ok);
+        if (!ok) {
+            return false;
+        }
+    }
+    return rect[0] < rect[2] && rect[1] < rect[3];
+}
+
+// Heights come from the same terrain function as Scene::terrainHeight. Gradients are hashed
+// from the seed and their lattice point, so a column's terrain doesn't depend on which other
+// columns are generated, and matches what the game generates there for the same seed
+static void generateColumn(const Terrain &terrain, int height, Column &column)
+{
+    float heights[16*16];
+    for (int x = 0; x < 16; x++) {
+        for (int z = 0; z < 16; z++) {
+            heights[x*16 + z] = terrain.sampleSeeded((column.x*16 + x) / (float) SCENE_DIM,
+                                                     (column.z*16 + z) / (float) SCENE_DIM);
+        }
+    }
+    for (int y_chunk = 0; y_chunk < height; y_chunk++) {
+        column.chunks.append(Scene::fillChunk(heights, y_chunk));
+    }
+}
+
+// Header, then each chunk as its position in chunks and its cells as one byte each, x-major
+static bool writeWorld(const QString &path, const QVector<Column> &columns, unsigned int seed, const int rect[4], int height)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out << FILE_MAGIC << FILE_VERSION << (quint32) seed;
+    out << (qint32) rect[0] << (qint32) rect[1] << (qint32) rect[2] << (qint32) rect[3] << (qint32) height;
+    char cells[16*16*16];
+    for (const Column &column : columns) {
+        for (int y_chunk = 0; y_chunk < column.chunks.size(); y_chunk++) {
+            const ChunkData *chunk = column.chunks[y_chunk];
+            int i = 0;
+            for (int x = 0; x < 16; x++) {
+                for (int y = 0; y < 16; y++) {
+                    for (int z = 0; z < 16; z++) {
+                        cells[i++] = (char) chunk->cells[x][y][z];
+                    }
+                }
+            }
+            out << (qint32) column.x << (qint32) y_chunk << (qint32) column.z;
+            out.writeRawData(cells, sizeof(cells));
+        }
+    }
+    return out.status() == QDataStream::Ok && file.flush();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("277-worldgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates chunks of the world without a window and reports the throughput.");
+    parser.addHelpOption();
+    QCommandLineOption seed_option("seed", "Terrain seed; defaults to $CIS277_SEED, or 277.", "seed");
+    QCommandLineOption rect_option("rect", "Chunk columns from x0,z0 up to x1,z1. Defaults to 0,0,16,16.", "x0,z0,x1,z1", "0,0,16,16");
+    QCommandLineOption height_option("height", "Chunks per column.", "chunks", QString::number(Scene::MAX_TERRAIN_HEIGHT));
+    QCommandLineOption mesh_option("mesh", "Mesh the chunks to CPU buffers: none, vertices or faces.", "format", "none");
+    QCommandLineOption out_option("out", "Write the chunks' cells to this file.", "file");
+    QCommandLineOption threads_option("threads", "Threads running jobs, this one included; defaults to one per core.", "n");
+    QCommandLineOption json_option("json", "Also write the report as JSON to this file.", "file");
+    parser.addOptions({seed_option, rect_option, height_option, mesh_option, out_option, threads_option, json_option});
+    parser.process(a);
+
+    unsigned int seed = 277;
+    QString seed_text = parser.isSet(seed_option) ? parser.value(seed_option) : QString(qgetenv("CIS277_SEED"));
+    if (!seed_text.isEmpty()) {
+        bool ok;
+        seed = seed_text.toUInt(&ok);
+        if (!ok) {
+            qWarning() << "Invalid seed" << seed_text;
+            return 2;
+        }
+    }
+    int rect[4];
+    if (!parseRect(parser.value(rect_option), rect)) {
+        qWarning() << "--rect needs x0,z0,x1,z1 with x0 < x1 and z0 < z1";
+        return 2;
+    }
+    bool ok;
+    int height = parser.value(height_option).toInt(&ok);
+    if (!ok || height < 1) {
+        qWarning() << "--height needs a positive number of chunks";
+        return 2;
+    }
+    QString mesh_format = parser.value(mesh_option);
+    if (mesh_format != "none" && mesh_format != "vertices" && mesh_format != "faces") {
+        qWarning() << "--mesh needs none, vertices or faces";
+        return 2;
+    }
+    int threads = 0;
+    if (parser.isSet(threads_option)) {
+        threads = parser.value(threads_option).toInt(&ok);
+        if (!ok || threads < 1) {
+            qWarning() << "--threads needs a positive number";
+            return 2;
+        }
+    }
+    // With one thread the system isn't started, and jobs run where they are submitted
+    if (threads != 1) {
+        JobSystem::start(threads - 1);
+    }
+
+    QVector<Column> columns;
+    for (int x = rect[0]; x < rect[2]; x++) {
+        for (int z = rect[1]; z < rect[3]; z++) {
+            Column column;
+            column.x = x;
+            column.z = z;
+            columns.append(column);
+        }
+    }
+
+    QVector<Stage> stages;
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+
+    // Creating seeds changes the terrain's maps, so they are made up front on one thread and
+    // the generate jobs only read them
+    timer.start();
+    Terrain::seed = seed;
+    Terrain terrain(SCENE_DIM, SCENE_DIM);
+    terrain.createSeeds(rect[0]*16 / (float) SCENE_DIM, rect[1]*16 / (float) SCENE_DIM,
+                        (rect[2]*16 - 1) / (float) SCENE_DIM, (rect[3]*16 - 1) / (float) SCENE_DIM);
+    stages.append({"seeds", timer.nsecsElapsed() / 1e6});
+
+    timer.start();
+    Column *column_data = columns.data();
+    JobSystem::parallelFor(columns.size(), 1, [&](int first, int end) {
+        for (int i = first; i < end; i++) {
+            generateColumn(terrain, height, column_data[i]);
+        }
+    });
+    stages.append({"generate", timer.nsecsElapsed() / 1e6});
+
+    qint64 mesh_bytes = 0;
+    qint64 mesh_faces = 0;
+    if (mesh_format != "none") {
+        bool packed = mesh_format == "faces";
+        timer.start();
+        JobSystem::parallelFor(columns.size(), 1, [=](int first, int end) {
+            for (int c = first; c < end; c++) {
+                Column &column = column_data[c];
+                column.meshes.resize(column.chunks.size());
+                for (int i = 0; i < column.chunks.size(); i++) {
+                    if (packed) {
+                        MeshData::buildFaces(column.chunks[i]->cells, column.meshes[i]);
+                    } else {
+                        MeshData::buildVertices(column.chunks[i]->cells, column.meshes[i]);
+                    }
+                }
+            }
+        });
+        stages.append({"mesh", timer.nsecsElapsed() / 1e6});
+        for (const Column &column : columns) {
+            for (const MeshData &mesh : column.meshes) {
+                mesh_bytes += mesh.bytes();
+                // Two triangles per face either way
+                mesh_faces += packed ? mesh.faces.size() : mesh.indices.size() / 6;
+            }
+        }
+    }
+    // The rest runs on this thread, so the job system is stopped before anything can fail
+    threads = JobSystem::threadCount();
+    JobSystem::stop();
+
+    if (parser.isSet(out_option)) {
+        timer.start();
+        if (!writeWorld(parser.value(out_option), columns, seed, rect, height)) {
+            qWarning() << "Couldn't write" << parser.value(out_option);
+            return 1;
+        }
+        stages.append({"write", timer.nsecsElapsed() / 1e6});
+    }
+    double total_ms = total.nsecsElapsed() / 1e6;
+
+    qint64 chunks = (qint64) columns.size() * height;
+    qint64 voxels = chunks * 16*16*16;
+    qint64 blocks = 0;
+    for (const Column &column : columns) {
+        for (const ChunkData *chunk : column.chunks) {
+            blocks += chunk->block_count;
+        }
+    }
+    double seconds = total_ms / 1000;
+    qint64 rss = peakRss();
+
+    printf("seed %u, columns %d,%d to %d,%d, %lld chunks, %d threads\n", seed, rect[0], rect[1], rect[2], rect[3],
+           (long long) chunks, threads);
+    for (const Stage &stage : stages) {
+        printf("%-10s %10.1f ms\n", qPrintable(stage.name), stage.ms);
+    }
+    printf("%-10s %10.1f ms\n", "total", total_ms);
+    printf("%.0f chunks/s, %.0f voxels/s, %lld blocks\n", chunks / seconds, voxels / seconds, (long long) blocks);
+    if (mesh_format != "none") {
+        printf("meshes: %lld faces, %.1f MiB\n", (long long) mesh_faces, mesh_bytes / (1024.0 * 1024.0));
+    }
+    printf("peak RSS %.1f MiB, peak chunk cells %.1f MiB\n", rss / (1024.0 * 1024.0),
+           MemoryStats::peakBytes(MEM_CHUNK_CELLS) / (1024.0 * 1024.0));
+
+    if (parser.isSet(json_option)) {
+        QJsonObject stage_times;
+        for (const Stage &stage : stages) {
+            stage_times[stage.name] = stage.ms;
+        }
+        QJsonObject report;
+        report["seed"] = (double) seed;
+        QJsonArray rect_array;
+        for (int i = 0; i < 4; i++) {
+            rect_array.append(rect[i]);
+        }
+        report["rect"] = rect_array;
+        report["height"] = height;
+        report["mesh"] = mesh_format;
+        report["threads"] = threads;
+        report["chunks"] = (double) chunks;
+        report["voxels"] = (double) voxels;
+        report["blocks"] = (double) blocks;
+        report["stage_ms"] = stage_times;
+        report["total_ms"] = total_ms;
+        report["chunks_per_second"] = chunks / seconds;
+        report["voxels_per_second"] = voxels / seconds;
+        report["mesh_faces"] = (double) mesh_faces;
+        report["mesh_bytes"] = (double) mesh_bytes;
+        report["peak_rss_bytes"] = (double) rss;
+        report["peak_chunk_cell_bytes"] = (double) MemoryStats::peakBytes(MEM_CHUNK_CELLS);
+        QFile file(parser.value(json_option));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Couldn't write" << parser.value(json_option);
+            return 1;
+        }
+        file.write(QJsonDocument(report).toJson());
+    }
+
+    for (const Column &column : columns) {
+        qDeleteAll(column.chunks);
+    }
+    return 0;
+}
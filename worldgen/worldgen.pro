@@ -0,0 +1,23 @@
+# Headless world generation on top of the world library; needs neither a display nor OpenGL
+QT += core gui
+
+TARGET = 277-worldgen
+TEMPLATE = app
+CONFIG += c++11
+CONFIG += warn_on
+CONFIG += console
+CONFIG -= app_bundle
+# Throughput only means something with optimizations on
+CONFIG -= debug
+CONFIG += release
+
+DESTDIR = $$OUT_PWD/..
+
+INCLUDEPATH += $$PWD/../include
+INCLUDEPATH += $$PWD/../src
+DEPENDPATH += $$PWD/../src
+LIBS += -L$$OUT_PWD/../world -lworld
+PRE_TARGETDEPS += $$OUT_PWD/../world/libworld.a
+
+SOURCES += \
+    $$PWD/main.cpp